@@ -0,0 +1,100 @@
+﻿/*
+ * Copyright (C) 2018-2019 xiaoliang<1296283984@qq.com>.
+ */
+
+/* Cost of an asynchronous call whose callee completes synchronously: task_bpd_asyn_call vs task_bpd_leaf_call */
+/* 被调用者同步完成时异步调用的开销：task_bpd_asyn_call与task_bpd_leaf_call对比 */
+
+/* gcc -O2 -o asyn_call asyn_call.c ../demo_linux/atask_port.c ../lib/atask.c */
+/* ./asyn_call [calls] */
+
+#include "../lib/atask.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_TASK_STACK_SIZE   1024
+
+static uint32_t calls = 50000000;
+static uint32_t sent;
+static task_t task;
+static uint8_t task_stack[BENCH_TASK_STACK_SIZE];
+
+/* Completes synchronously, like a send that finishes inline */
+/* 同步完成，如同内联完成的发送 */
+static void bench_send(task_t *task, event_t *ev, uint32_t len)
+{
+    uint8_t *bpd = TASK_BPD(task);
+    struct vars
+    {
+        uint32_t len;
+    } *vars = (struct vars *)task_asyn_vars_get(task, sizeof(*vars));
+
+    bpd_begin(0);
+
+    vars->len = len;
+    sent += vars->len;
+    task->ret_val.u32 = 0;
+
+    bpd_end();
+    task_asyn_return(task);
+}
+
+static void bench_asyn_call_task(task_t *task, event_t *ev)
+{
+    uint8_t *bpd = TASK_BPD(task);
+    struct vars
+    {
+        uint32_t i;
+    } *vars = (struct vars *)task_asyn_vars_get(task, sizeof(*vars));
+
+    bpd_begin(1);
+
+    for (vars->i = 0; vars->i < calls; vars->i++)
+    {
+        task_bpd_asyn_call(1, task, bench_send, vars->i);
+    }
+
+    bpd_end();
+    task_asyn_return(task);
+}
+
+static void bench_leaf_call_task(task_t *task, event_t *ev)
+{
+    uint8_t *bpd = TASK_BPD(task);
+    struct vars
+    {
+        uint32_t i;
+    } *vars = (struct vars *)task_asyn_vars_get(task, sizeof(*vars));
+
+    bpd_begin(1);
+
+    for (vars->i = 0; vars->i < calls; vars->i++)
+    {
+        task_bpd_leaf_call(1, task, bench_send, vars->i);
+    }
+
+    bpd_end();
+    task_asyn_return(task);
+}
+
+static double run(task_asyn_routine_t func)
+{
+    time_nclk_t start;
+
+    task_init(&task, task_stack, sizeof(task_stack), 0);
+    start = time_nclk_get();
+    task_start(&task, func);
+    TASK_ASSERT(task_is_end(&task));
+
+    return (double)time_nclk_to_us(time_nclk_get() - start) * 1000 / calls;
+}
+
+int main(int argc, char *argv[])
+{
+    calls = argc > 1 ? (uint32_t)atoi(argv[1]) : calls;
+
+    printf("task_bpd_asyn_call: %.2f ns/call\n", run(bench_asyn_call_task));
+    printf("task_bpd_leaf_call: %.2f ns/call\n", run(bench_leaf_call_task));
+
+    return sent == 0;
+}
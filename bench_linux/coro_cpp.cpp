@@ -0,0 +1,189 @@
+﻿/*
+ * Copyright (C) 2018-2019 xiaoliang<1296283984@qq.com>.
+ */
+
+/* C++20 coroutines of atask.hpp vs bp coroutines on the same workload: */
+/* each task repeatedly calls a child which yields through the event loop and returns a value */
+/* atask.hpp的C++20协程与bp协程在相同负载下的对比： */
+/* 每个任务反复调用一个经事件循环挂起一次并返回值的子协程 */
+
+/* gcc -O2 -c ../demo_linux/atask_port.c ../lib/atask.c */
+/* g++ -std=c++20 -O2 -o coro_cpp coro_cpp.cpp atask_port.o atask.o */
+/* ./coro_cpp [tasks] [rounds] */
+
+#include "../lib/atask.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_TASK_STACK_SIZE   256
+#define BENCH_FRAME_BLK_SIZE    256
+
+static uint32_t task_nums = 1000;
+static uint32_t rounds = 5000;
+static uint32_t ended;
+static uint64_t sum;
+
+/* bp: the child yields once and returns i */
+/* bp：子协程挂起一次并返回i */
+static void bp_step(task_t *task, event_t *ev, uint32_t i)
+{
+    uint8_t *bpd = TASK_BPD(task);
+    struct vars
+    {
+        uint32_t i;
+    } *vars = (struct vars *)task_asyn_vars_get(task, sizeof(*vars));
+
+    bpd_begin(1);
+
+    vars->i = i;
+    el_event_post(&task->event);
+    bpd_yield(1);
+    task->ret_val.u32 = vars->i;
+
+    bpd_end();
+    task_asyn_return(task);
+}
+
+static void bp_task(task_t *task, event_t *ev)
+{
+    uint8_t *bpd = TASK_BPD(task);
+    struct vars
+    {
+        uint32_t i;
+        uint64_t sum;
+    } *vars = (struct vars *)task_asyn_vars_get(task, sizeof(*vars));
+
+    bpd_begin(1);
+
+    vars->sum = 0;
+
+    for (vars->i = 0; vars->i < rounds; vars->i++)
+    {
+        task_bpd_asyn_call(1, task, bp_step, vars->i);
+        vars->sum += task->ret_val.u32;
+    }
+
+    sum += vars->sum;
+    ended++;
+
+    bpd_end();
+    task_asyn_return(task);
+}
+
+/* C++: the same child and task */
+/* C++：相同的子协程与任务 */
+static atask::co_task<uint32_t> co_step(uint32_t i)
+{
+    co_await atask::yield();
+    co_return i;
+}
+
+static atask::co_task<> co_task_main()
+{
+    uint64_t s = 0;
+    uint32_t i;
+
+    for (i = 0; i < rounds; i++)
+    {
+        s += co_await co_step(i);
+    }
+
+    sum += s;
+    ended++;
+}
+
+/* Schedule until every task ended, return ns per round of a task */
+/* 调度直到全部任务结束，返回每个任务每轮的纳秒数 */
+static double drive(time_nclk_t start)
+{
+    while (ended < task_nums)
+    {
+        el_schedule();
+    }
+
+    return (double)time_nclk_to_us(time_nclk_get() - start) * 1000 / ((double)task_nums * rounds);
+}
+
+static double run_bp(void)
+{
+    task_t *tasks = (task_t *)malloc(sizeof(task_t) * task_nums);
+    uint8_t *stacks = (uint8_t *)malloc((size_t)BENCH_TASK_STACK_SIZE * task_nums);
+    time_nclk_t start;
+    double ns;
+    uint32_t i;
+
+    sum = 0;
+    ended = 0;
+    start = time_nclk_get();
+
+    for (i = 0; i < task_nums; i++)
+    {
+        task_init(&tasks[i], stacks + (size_t)BENCH_TASK_STACK_SIZE * i, BENCH_TASK_STACK_SIZE, 0);
+        task_start(&tasks[i], bp_task);
+    }
+
+    ns = drive(start);
+
+    free(stacks);
+    free(tasks);
+
+    return ns;
+}
+
+static double run_co(void)
+{
+    uint32_t buf_size = BENCH_FRAME_BLK_SIZE * (task_nums * 2 + 1);
+    uint8_t *buff = (uint8_t *)malloc(buf_size);
+    slab_t frame_slab;
+    time_nclk_t start;
+    double ns;
+    uint32_t i;
+
+    slab_init_lazy(&frame_slab, buff, buf_size, BENCH_FRAME_BLK_SIZE);
+    atask::frame_slab_set(&frame_slab);
+
+    sum = 0;
+    ended = 0;
+    start = time_nclk_get();
+
+    for (i = 0; i < task_nums; i++)
+    {
+        if (!atask::spawn(co_task_main()))
+        {
+            printf("frame slab exhausted\n");
+            exit(1);
+        }
+    }
+
+    ns = drive(start);
+
+    atask::frame_slab_set(NULL);
+    free(buff);
+
+    return ns;
+}
+
+int main(int argc, char *argv[])
+{
+    double bp_ns;
+    double co_ns;
+    uint64_t bp_sum;
+
+    task_nums = argc > 1 ? (uint32_t)atoi(argv[1]) : task_nums;
+    rounds = argc > 2 ? (uint32_t)atoi(argv[2]) : rounds;
+
+    bp_ns = run_bp();
+    bp_sum = sum;
+    co_ns = run_co();
+
+    if (sum != bp_sum)
+    {
+        printf("result mismatch\n");
+        return 1;
+    }
+
+    printf("tasks %u, call + yield: bp %.2f ns, C++ coroutine %.2f ns\n", task_nums, bp_ns, co_ns);
+    printf("memory: bp stack %d B per task, largest C++ frame %zu B\n", BENCH_TASK_STACK_SIZE, atask::frame_size_peak);
+
+    return 0;
+}
@@ -0,0 +1,157 @@
+﻿/*
+ * Copyright (C) 2018-2019 xiaoliang<1296283984@qq.com>.
+ */
+
+/* Memory of idle connection tasks and the cost of waking them, with and without task_hibernate */
+/* 空闲连接任务占用的内存以及唤醒开销，使用与不使用task_hibernate的对比 */
+
+/* gcc -O2 -o hibernate hibernate.c ../demo_linux/atask_port.c ../lib/atask.c */
+/* ./hibernate [tasks] */
+
+#include "../lib/atask.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_TASK_STACK_SIZE   (256 + 3072)
+#define BENCH_HIB_MIN_BLK_SIZE  256
+#define BENCH_HIB_CLASSES       2
+
+static task_pool_t pool;
+static slab_cache_t hib_cache;
+static slab_t hib_classes[BENCH_HIB_CLASSES];
+static sem_t *sems;
+static uint32_t task_nums = 30000;
+static uint32_t ended;
+static bool hibernate;
+
+/* Handle one request with a 2 KB buffer, like the request task of the http server */
+/* 使用2KB缓冲区处理一个请求，与http服务器的请求任务相同 */
+static void bench_request(task_t *task, event_t *ev, uint32_t id)
+{
+    uint8_t *bpd = TASK_BPD(task);
+    struct vars
+    {
+        uint8_t buf[2048];
+    } *vars = task_asyn_vars_get(task, sizeof(*vars));
+
+    bpd_begin(0);
+
+    memset(vars->buf, (int)id, sizeof(vars->buf));
+    task->ret_val.u32 = vars->buf[id % sizeof(vars->buf)];
+
+    bpd_end();
+    task_asyn_return(task);
+}
+
+/* Serve a request, then stay idle until the connection sends the next one */
+/* 处理一个请求，然后空闲直到连接发送下一个请求 */
+static void bench_conn_task(task_t *task, event_t *ev, uint32_t id)
+{
+    uint8_t *bpd = TASK_BPD(task);
+    struct vars
+    {
+        uint32_t id;
+    } *vars = task_asyn_vars_get(task, sizeof(*vars));
+
+    bpd_begin(3);
+
+    vars->id = id;
+
+    task_bpd_asyn_call(1, task, bench_request, vars->id);
+
+    sem_take(&sems[vars->id], hibernate ? task_hibernate(task, &hib_cache) : &task->event);
+    bpd_yield(2);
+
+    task_bpd_asyn_call(3, task, bench_request, vars->id);
+
+    ended++;
+
+    bpd_end();
+    task_asyn_return(task);
+}
+
+static size_t idle_bytes(void)
+{
+    size_t bytes = (size_t)pool.slab.nums_used * pool.slab.blk_size;
+    uint32_t i;
+
+    for (i = 0; i < BENCH_HIB_CLASSES; i++)
+    {
+        bytes += (size_t)hib_classes[i].nums_used * hib_classes[i].blk_size;
+    }
+
+    return bytes;
+}
+
+static void run(const char *name)
+{
+    time_nclk_t start;
+    size_t bytes;
+    uint32_t i;
+    task_t *task;
+
+    ended = 0;
+
+    for (i = 0; i < task_nums; i++)
+    {
+        sem_init(&sems[i], 1);
+        task_pool_spawn(&pool, task, bench_conn_task, i);
+    }
+
+    while (el_have_imm_event())
+    {
+        el_schedule();
+    }
+
+    bytes = idle_bytes();
+
+    /* every connection sends its next request */
+    /* 每个连接发送下一个请求 */
+    start = time_nclk_get();
+
+    for (i = 0; i < task_nums; i++)
+    {
+        sem_give(&sems[i], NULL);
+    }
+
+    while (ended < task_nums)
+    {
+        el_schedule();
+    }
+
+    printf("%-12s tasks %u, idle %zu B per task, wake %.1f ns per task\n",
+            name, task_nums, bytes / task_nums,
+            (double)time_nclk_to_us(time_nclk_get() - start) * 1000 / task_nums);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t pool_size;
+    uint32_t cache_size;
+    void *pool_buff;
+    void *cache_buff;
+
+    task_nums = argc > 1 ? (uint32_t)atoi(argv[1]) : task_nums;
+
+    pool_size = (uint32_t)TASK_POOL_BUFF_SIZE(BENCH_TASK_STACK_SIZE, task_nums);
+    cache_size = BENCH_HIB_MIN_BLK_SIZE * task_nums * BENCH_HIB_CLASSES * 2;
+    pool_buff = malloc(pool_size);
+    cache_buff = malloc(cache_size);
+    sems = (sem_t *)malloc(sizeof(sem_t) * task_nums);
+
+    task_pool_init(&pool, pool_buff, pool_size, BENCH_TASK_STACK_SIZE, 0);
+    slab_cache_init_pow2(&hib_cache, hib_classes, BENCH_HIB_CLASSES, cache_buff, cache_size, BENCH_HIB_MIN_BLK_SIZE);
+
+    hibernate = false;
+    run("task pool");
+
+    hibernate = true;
+    run("hibernated");
+
+    free(sems);
+    free(cache_buff);
+    free(pool_buff);
+
+    return 0;
+}
@@ -0,0 +1,181 @@
+﻿/*
+ * Copyright (C) 2018-2019 xiaoliang<1296283984@qq.com>.
+ */
+
+/* Task resume throughput with task stacks on 4 KB pages vs 2 MB huge pages, with and without block colouring */
+/* 任务栈位于4KB页与2MB大页时的任务恢复吞吐量，以及是否启用块着色的对比 */
+
+/* gcc -O2 -DCONFIG_SLAB_GROWABLE -o hugepage hugepage.c ../demo_linux/atask_port.c ../lib/atask.c */
+/* ./hugepage [tasks] [rounds] */
+
+#include "../lib/atask.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef CONFIG_SLAB_GROWABLE
+#error "build with -DCONFIG_SLAB_GROWABLE"
+#endif
+
+#define BENCH_TASK_STACK_SIZE   (256 + 3072)
+#define BENCH_CHUNK_SIZE        (2 * 1024 * 1024)
+#define BENCH_COLOUR_SIZE       64
+
+extern const slab_page_provider_t slab_mmap_provider;
+extern const slab_page_provider_t slab_hugepage_provider;
+
+/* same layout as the per-connection task of the http server */
+/* 与http服务器中每个连接的任务布局相同 */
+struct bench_task_s
+{
+    task_t task;
+    uint8_t stack[BENCH_TASK_STACK_SIZE];
+};
+
+static slab_t tasks_slab;
+static struct bench_task_s **tasks;
+static uint32_t *order;
+
+/* Each resume touches the task and a few lines of its stack, then waits to be posted again */
+/* 每次恢复访问任务及其栈中的若干缓存行，然后等待再次被提交 */
+static void bench_task(task_t *task, event_t *ev)
+{
+    uint8_t *bpd = TASK_BPD(task);
+    struct vars
+    {
+        uint32_t resumes;
+        uint8_t scratch[256];
+    } *vars = task_asyn_vars_get(task, sizeof(*vars));
+
+    bpd_begin(1);
+
+    memset(vars->scratch, 0, sizeof(vars->scratch));
+
+    for (vars->resumes = 0; ; vars->resumes++)
+    {
+        vars->scratch[(vars->resumes * 64) % sizeof(vars->scratch)]++;
+        bpd_yield(1);
+    }
+
+    bpd_end();
+}
+
+/* Print the huge page usage of the process */
+/* 打印进程的大页使用情况 */
+static void hugepage_usage_print(void)
+{
+    char line[128];
+    FILE *fp = fopen("/proc/self/smaps_rollup", "r");
+
+    if (fp == NULL)
+    {
+        return;
+    }
+
+    while (fgets(line, sizeof(line), fp))
+    {
+        if (strncmp(line, "AnonHugePages:", 14) == 0 || strncmp(line, "Private_Hugetlb:", 16) == 0)
+        {
+            printf("    %s", line);
+        }
+    }
+
+    fclose(fp);
+}
+
+static double run(const char *name, const slab_page_provider_t *provider, uint32_t colour_size,
+                  uint32_t task_nums, uint32_t rounds)
+{
+    time_nclk_t start;
+    double sec;
+    uint32_t i;
+    uint32_t r;
+
+    slab_init_growable(&tasks_slab, sizeof(struct bench_task_s), BENCH_CHUNK_SIZE, provider, 0);
+    slab_colour_set(&tasks_slab, colour_size);
+
+    for (i = 0; i < task_nums; i++)
+    {
+        tasks[i] = (struct bench_task_s *)slab_alloc(&tasks_slab);
+        if (tasks[i] == NULL)
+        {
+            printf("%s: out of memory\n", name);
+            exit(1);
+        }
+
+        task_init(&tasks[i]->task, tasks[i]->stack, sizeof(tasks[i]->stack), 0);
+        task_start(&tasks[i]->task, bench_task);
+    }
+
+    /* resume in random order, as connections become ready */
+    /* 按随机顺序恢复，模拟连接随机就绪 */
+    start = time_nclk_get();
+
+    for (r = 0; r < rounds; r++)
+    {
+        for (i = 0; i < task_nums; i++)
+        {
+            el_event_post(&tasks[order[i]]->task.event);
+        }
+
+        while (el_have_imm_event())
+        {
+            el_schedule();
+        }
+    }
+
+    sec = (double)time_nclk_to_us(time_nclk_get() - start) / 1000000;
+
+    printf("%-24s tasks %u, %.2f M resumes/s\n", name, task_nums, (double)task_nums * rounds / sec / 1000000);
+    hugepage_usage_print();
+
+    /* return the chunks to the system */
+    /* 将chunk归还给系统 */
+    for (i = 0; i < task_nums; i++)
+    {
+        slab_free(&tasks_slab, tasks[i]);
+    }
+
+    while (tasks_slab.blk_nums)
+    {
+        el_schedule();
+    }
+
+    return sec;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t task_nums = argc > 1 ? (uint32_t)atoi(argv[1]) : 30000;
+    uint32_t rounds = argc > 2 ? (uint32_t)atoi(argv[2]) : 200;
+    uint32_t i;
+    uint32_t j;
+    uint32_t t;
+
+    tasks = (struct bench_task_s **)malloc(sizeof(*tasks) * task_nums);
+    order = (uint32_t *)malloc(sizeof(*order) * task_nums);
+
+    srand(1);
+    for (i = 0; i < task_nums; i++)
+    {
+        order[i] = i;
+    }
+
+    for (i = task_nums - 1; i > 0; i--)
+    {
+        j = (uint32_t)rand() % (i + 1);
+        t = order[i];
+        order[i] = order[j];
+        order[j] = t;
+    }
+
+    run("4 KB pages", &slab_mmap_provider, 0, task_nums, rounds);
+    run("4 KB pages, colour", &slab_mmap_provider, BENCH_COLOUR_SIZE, task_nums, rounds);
+    run("2 MB huge pages", &slab_hugepage_provider, 0, task_nums, rounds);
+    run("2 MB huge pages, colour", &slab_hugepage_provider, BENCH_COLOUR_SIZE, task_nums, rounds);
+
+    free(order);
+    free(tasks);
+
+    return 0;
+}
@@ -0,0 +1,141 @@
+﻿/*
+ * Copyright (C) 2018-2019 xiaoliang<1296283984@qq.com>.
+ */
+
+/* Multi-thread alloc/free benchmark: shared slab under a mutex vs magazine caches */
+/* 多线程分配/释放基准测试：互斥锁保护的共享slab与弹匣缓存对比 */
+
+/* gcc -O2 -o slab_mag slab_mag.c ../demo_linux/atask_port.c ../lib/atask.c -lpthread */
+/* ./slab_mag [threads] [batch] [rounds] */
+
+#include "../lib/slab_mag.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_BLK_SIZE      64
+#define BENCH_MAX_THREADS   64
+
+static slab_t shared_slab;
+static pthread_mutex_t shared_mutex = PTHREAD_MUTEX_INITIALIZER;
+static slab_depot_t depot;
+
+static int batch = 64;
+static int rounds = 200000;
+
+/* Allocate and free a batch of blocks with the shared slab under a mutex */
+/* 在互斥锁保护下使用共享slab分配与释放一批块 */
+static void *mutex_worker(void *arg)
+{
+    void **blks = (void **)malloc(sizeof(void *) * batch);
+    int r, i;
+
+    for (r = 0; r < rounds; r++)
+    {
+        for (i = 0; i < batch; i++)
+        {
+            pthread_mutex_lock(&shared_mutex);
+            blks[i] = slab_alloc(&shared_slab);
+            pthread_mutex_unlock(&shared_mutex);
+        }
+
+        for (i = 0; i < batch; i++)
+        {
+            pthread_mutex_lock(&shared_mutex);
+            slab_free(&shared_slab, blks[i]);
+            pthread_mutex_unlock(&shared_mutex);
+        }
+    }
+
+    free(blks);
+
+    return NULL;
+}
+
+/* Allocate and free a batch of blocks with a magazine cache */
+/* 使用弹匣缓存分配与释放一批块 */
+static void *mag_worker(void *arg)
+{
+    void **blks = (void **)malloc(sizeof(void *) * batch);
+    slab_mag_cache_t cache;
+    int r, i;
+
+    slab_mag_cache_init(&cache, &depot);
+
+    for (r = 0; r < rounds; r++)
+    {
+        for (i = 0; i < batch; i++)
+        {
+            blks[i] = slab_mag_alloc(&cache);
+        }
+
+        for (i = 0; i < batch; i++)
+        {
+            slab_mag_free(&cache, blks[i]);
+        }
+    }
+
+    slab_mag_cache_drain(&cache);
+    free(blks);
+
+    return NULL;
+}
+
+static double run(void *(*worker)(void *), int threads)
+{
+    pthread_t tids[BENCH_MAX_THREADS];
+    time_nclk_t start;
+    int i;
+
+    start = time_nclk_get();
+
+    for (i = 0; i < threads; i++)
+    {
+        pthread_create(&tids[i], NULL, worker, NULL);
+    }
+
+    for (i = 0; i < threads; i++)
+    {
+        pthread_join(tids[i], NULL);
+    }
+
+    return (double)time_nclk_to_us(time_nclk_get() - start) / 1000000;
+}
+
+int main(int argc, char *argv[])
+{
+    int threads = argc > 1 ? atoi(argv[1]) : 4;
+    uint32_t blk_nums;
+    uint32_t mag_nums;
+    uint8_t *buff;
+    slab_mag_t *mags;
+    double ops;
+    double sec;
+
+    batch = argc > 2 ? atoi(argv[2]) : batch;
+    rounds = argc > 3 ? atoi(argv[3]) : rounds;
+    threads = threads > BENCH_MAX_THREADS ? BENCH_MAX_THREADS : threads;
+
+    /* enough blocks for every thread to hold a batch and two magazines */
+    /* 足够每个线程持有一批块与两个弹匣的块数 */
+    blk_nums = threads * (batch + CONFIG_SLAB_MAG_SIZE * 2) + CONFIG_SLAB_MAG_SIZE * 4;
+    buff = (uint8_t *)malloc((size_t)blk_nums * BENCH_BLK_SIZE + sizeof(void *));
+    mag_nums = threads * 2 + blk_nums / CONFIG_SLAB_MAG_SIZE + 1;
+    mags = (slab_mag_t *)malloc(sizeof(slab_mag_t) * mag_nums);
+
+    ops = (double)threads * rounds * batch * 2;
+
+    slab_init_lazy(&shared_slab, buff, blk_nums * BENCH_BLK_SIZE + sizeof(void *), BENCH_BLK_SIZE);
+    sec = run(mutex_worker, threads);
+    printf("mutex slab:     threads %d, %.1f Mops/s\n", threads, ops / sec / 1000000);
+
+    slab_init_lazy(&shared_slab, buff, blk_nums * BENCH_BLK_SIZE + sizeof(void *), BENCH_BLK_SIZE);
+    slab_depot_init(&depot, &shared_slab, mags, mag_nums);
+    sec = run(mag_worker, threads);
+    printf("magazine cache: threads %d, %.1f Mops/s\n", threads, ops / sec / 1000000);
+
+    free(mags);
+    free(buff);
+
+    return 0;
+}
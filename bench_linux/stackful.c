@@ -0,0 +1,171 @@
+﻿/*
+ * Copyright (C) 2018-2019 xiaoliang<1296283984@qq.com>.
+ */
+
+/* Context switch cost of the stackful backend vs bp coroutines, alone and under a deep call chain */
+/* 有栈后端与bp协程的上下文切换开销对比，包括单独切换与深调用链 */
+
+/* gcc -O2 -DCONFIG_TASK_STACKFUL -o stackful stackful.c ../demo_linux/atask_port.c ../lib/atask.c */
+/* ./stackful [rounds] */
+
+#include "../lib/atask.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef CONFIG_TASK_STACKFUL
+#error "build with -DCONFIG_TASK_STACKFUL"
+#endif
+
+#define BENCH_TASK_STACK_SIZE   16384
+#define BENCH_DEPTH             8
+
+static uint32_t rounds = 20000000;
+static task_t task;
+static uint8_t task_stack[BENCH_TASK_STACK_SIZE];
+
+/* bp: yield once per resume */
+/* bp：每次恢复挂起一次 */
+static void bp_switch_task(task_t *task, event_t *ev)
+{
+    uint8_t *bpd = TASK_BPD(task);
+    struct vars
+    {
+        uint32_t i;
+    } *vars = (struct vars *)task_asyn_vars_get(task, sizeof(*vars));
+
+    bpd_begin(1);
+
+    for (vars->i = 0; vars->i < rounds; vars->i++)
+    {
+        bpd_yield(1);
+    }
+
+    bpd_end();
+    task_asyn_return(task);
+}
+
+/* bp: a chain of BENCH_DEPTH asynchronous calls, the last one yields */
+/* bp：BENCH_DEPTH层异步调用链，最后一层挂起 */
+static void bp_chain(task_t *task, event_t *ev, uint32_t depth)
+{
+    uint8_t *bpd = TASK_BPD(task);
+    struct vars
+    {
+        uint32_t depth;
+    } *vars = (struct vars *)task_asyn_vars_get(task, sizeof(*vars));
+
+    bpd_begin(2);
+
+    vars->depth = depth;
+
+    if (vars->depth == 0)
+    {
+        bpd_yield(1);
+    }
+    else
+    {
+        task_bpd_asyn_call(2, task, bp_chain, vars->depth - 1);
+    }
+
+    bpd_end();
+    task_asyn_return(task);
+}
+
+static void bp_chain_task(task_t *task, event_t *ev)
+{
+    uint8_t *bpd = TASK_BPD(task);
+    struct vars
+    {
+        uint32_t i;
+    } *vars = (struct vars *)task_asyn_vars_get(task, sizeof(*vars));
+
+    bpd_begin(1);
+
+    for (vars->i = 0; vars->i < rounds; vars->i++)
+    {
+        task_bpd_asyn_call(1, task, bp_chain, BENCH_DEPTH - 1);
+    }
+
+    bpd_end();
+    task_asyn_return(task);
+}
+
+/* stackful: yield once per resume */
+/* 有栈：每次恢复挂起一次 */
+static void sf_switch_task(task_t *task, void *arg)
+{
+    uint32_t i;
+
+    for (i = 0; i < rounds; i++)
+    {
+        task_stackful_yield(task);
+    }
+}
+
+/* stackful: the same chain with plain C calls */
+/* 有栈：使用普通C调用的相同调用链 */
+static __attribute__((noinline)) void sf_chain(task_t *task, uint32_t depth)
+{
+    if (depth == 0)
+    {
+        task_stackful_yield(task);
+    }
+    else
+    {
+        sf_chain(task, depth - 1);
+    }
+}
+
+static void sf_chain_task(task_t *task, void *arg)
+{
+    uint32_t i;
+
+    for (i = 0; i < rounds; i++)
+    {
+        sf_chain(task, BENCH_DEPTH - 1);
+    }
+}
+
+/* Resume the task until it ends, return ns per resume */
+/* 恢复任务直到其结束，返回每次恢复的纳秒数 */
+static double drive(time_nclk_t start)
+{
+    while (!task_is_end(&task))
+    {
+        el_event_sync_post(&task.event);
+    }
+
+    return (double)time_nclk_to_us(time_nclk_get() - start) * 1000 / rounds;
+}
+
+static double run_bp(task_asyn_routine_t func)
+{
+    time_nclk_t start;
+
+    task_init(&task, task_stack, sizeof(task_stack), 0);
+    start = time_nclk_get();
+    task_start(&task, func);
+
+    return drive(start);
+}
+
+static double run_sf(task_stackful_routine_t func)
+{
+    time_nclk_t start;
+
+    task_init(&task, task_stack, sizeof(task_stack), 0);
+    start = time_nclk_get();
+    task_stackful_start(&task, func, NULL);
+
+    return drive(start);
+}
+
+int main(int argc, char *argv[])
+{
+    rounds = argc > 1 ? (uint32_t)atoi(argv[1]) : rounds;
+
+    printf("resume + yield:          bp %.2f ns, stackful %.2f ns\n", run_bp(bp_switch_task), run_sf(sf_switch_task));
+    printf("resume under %d calls:    bp %.2f ns, stackful %.2f ns\n", BENCH_DEPTH, run_bp(bp_chain_task), run_sf(sf_chain_task));
+
+    return 0;
+}
@@ -5,6 +5,11 @@
 #include "../lib/atask.h"
 #include <time.h>
 
+#ifdef CONFIG_SLAB_GROWABLE
+#include <stdint.h>
+#include <sys/mman.h>
+#endif
+
 /* get the current time, unit is number of clocks */
 /* 获取当前时间时钟数 */
 time_nclk_t time_nclk_get(void)
@@ -43,3 +48,129 @@ time_nclk_t time_us_to_nclk(time_us_t time_us)
 {
     return time_us * 1000;
 }
+
+
+#ifdef CONFIG_SLAB_GROWABLE
+
+#ifndef MAP_HUGETLB
+#define MAP_HUGETLB 0x40000
+#endif
+
+/* map a chunk aligned to its size, map twice the size and unmap the unaligned head and tail,
+ * the size is a multiple of the page size of the mapping, so are the head and tail */
+/* 映射按其大小对齐的chunk，映射两倍大小并解除未对齐的头尾部分，
+ * size为映射页大小的整数倍，头尾部分同样如此 */
+static void *slab_mmap_chunk_map(size_t size, int flags)
+{
+    uint8_t *map;
+    uint8_t *chunk;
+
+    map = (uint8_t *)mmap(NULL, size * 2, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+    if (map == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    chunk = (uint8_t *)(((uintptr_t)map + size - 1) & ~((uintptr_t)size - 1));
+
+    if (chunk > map)
+    {
+        munmap(map, chunk - map);
+    }
+
+    if (map + size * 2 > chunk + size)
+    {
+        munmap(chunk + size, map + size * 2 - (chunk + size));
+    }
+
+    return chunk;
+}
+
+
+/* allocate a chunk aligned to its size */
+/* 分配按其大小对齐的chunk */
+static void *slab_mmap_chunk_alloc(void *ctx, size_t size)
+{
+    (void)ctx;
+
+    return slab_mmap_chunk_map(size, 0);
+}
+
+
+/* return a chunk to the system */
+/* 将chunk归还给系统 */
+static void slab_mmap_chunk_free(void *ctx, void *mem, size_t size)
+{
+    (void)ctx;
+
+    munmap(mem, size);
+}
+
+
+/* page provider of the growable slab based on mmap, chunk size is a multiple of the page size */
+/* 基于mmap的可增长slab页提供者，chunk大小为页大小的整数倍 */
+const slab_page_provider_t slab_mmap_provider =
+{
+    slab_mmap_chunk_alloc,
+    slab_mmap_chunk_free,
+    NULL
+};
+
+
+/* allocate a chunk backed by 2 MB huge pages,
+ * try MAP_HUGETLB with the exact size first, it is usually aligned to 2 MB only,
+ * over-map and trim it when it is not aligned to the chunk size,
+ * and fall back to an aligned mapping advised as a transparent huge page
+ * when the huge page pool is not enough */
+/* 分配由2MB大页支撑的chunk，
+ * 优先以实际大小尝试MAP_HUGETLB，其通常仅按2MB对齐，
+ * 未按chunk大小对齐时改为超量映射后裁剪，
+ * 大页池不足时回退为对齐的普通映射并建议内核使用透明大页 */
+static void *slab_hugepage_chunk_alloc(void *ctx, size_t size)
+{
+    void *chunk;
+
+    (void)ctx;
+
+    chunk = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (chunk != MAP_FAILED)
+    {
+        if (((uintptr_t)chunk & ((uintptr_t)size - 1)) == 0)
+        {
+            return chunk;
+        }
+
+        munmap(chunk, size);
+
+        chunk = slab_mmap_chunk_map(size, MAP_HUGETLB);
+        if (chunk != NULL)
+        {
+            return chunk;
+        }
+    }
+
+    chunk = slab_mmap_chunk_map(size, 0);
+
+#ifdef MADV_HUGEPAGE
+    if (chunk != NULL)
+    {
+        madvise(chunk, size, MADV_HUGEPAGE);
+    }
+#endif
+
+    return chunk;
+}
+
+
+/* page provider of the growable slab based on 2 MB huge pages, chunk size is a multiple of 2 MB */
+/* 基于2MB大页的可增长slab页提供者，chunk大小为2MB的整数倍 */
+const slab_page_provider_t slab_hugepage_provider =
+{
+    slab_hugepage_chunk_alloc,
+    slab_mmap_chunk_free,
+    NULL
+};
+
+#endif /* CONFIG_SLAB_GROWABLE */
@@ -0,0 +1,238 @@
+﻿/*
+ * Copyright (C) 2018-2019 xiaoliang<1296283984@qq.com>.
+ */
+
+/* Cancelling tasks blocked in nested asynchronous calls */
+/* 取消阻塞在嵌套异步调用中的任务 */
+
+/* gcc -O2 -DCONFIG_TASK_CANCEL -o cancel cancel.c atask_port.c ../lib/atask.c */
+/* ./cancel */
+
+#include "../lib/atask.h"
+#include <stdio.h>
+#include <unistd.h>
+
+#ifndef CONFIG_TASK_CANCEL
+#error "build with -DCONFIG_TASK_CANCEL"
+#endif
+
+/* reply of the upstream, resolved by the main loop */
+/* 上游的应答，由主循环完成 */
+static future_t reply = FUTURE_STATIC_INIT(reply);
+
+/* configuration reload notification */
+/* 配置重载通知 */
+static acond_t reload = ACOND_STATIC_INIT(reload);
+
+/* Innermost function: wait for the reply of the upstream */
+/* 最内层函数：等待上游的应答 */
+static void wait_reply(task_t *task, event_t *ev)
+{
+    uint8_t *bpd = TASK_BPD(task);
+    struct vars
+    {
+        task_cancel_reg_t reg;
+    } *vars = task_asyn_vars_get(task, sizeof(*vars));
+
+    bpd_begin(1);
+
+    if (future_await(&reply, &task->event) == FUTURE_AWAIT_PENDING)
+    {
+        /* registered once before the yield, dropped when the function returns */
+        /* 在yield之前登记一次，函数返回时被丢弃 */
+        task_cancel_reg_future(task, &vars->reg, &reply, &task->event);
+        bpd_yield(1);
+        task_bpd_cancel_check(task);
+    }
+
+    /* one reply per request */
+    /* 每个请求一个应答 */
+    task->ret_val.s32 = FUTURE_VALUE(&reply, s32);
+    future_reset(&reply);
+
+    bpd_end();
+
+    task_asyn_return(task);
+}
+
+/* Timeout of a request */
+/* 请求超时 */
+static void on_request_timeout(void *ctx, event_t *ev)
+{
+    printf("request %u: late\n", *(uint32_t *)ctx);
+}
+
+/* Middle function: a request with a timeout, the reply is awaited in a nested call */
+/* 中间层函数：带超时的请求，在嵌套调用中等待应答 */
+static void request(task_t *task, event_t *ev, uint32_t id)
+{
+    uint8_t *bpd = TASK_BPD(task);
+    struct vars
+    {
+        timer_event_t timeout;
+        task_cancel_reg_t reg;
+        uint32_t id;
+    } *vars = task_asyn_vars_get(task, sizeof(*vars));
+
+    bpd_begin(1);
+
+    vars->id = id;
+
+    /* the timeout timer is not inherited, it only reports the request as late */
+    /* 超时定时器不继承任务事件，只用于报告请求超时 */
+    timer_init(&vars->timeout, on_request_timeout, &vars->id, LOWER_GROUP_PRIORITY);
+    el_timer_start_ms(&vars->timeout, 5000);
+    task_cancel_reg_timer(task, &vars->reg, &vars->timeout);
+
+    printf("request %u: waiting for the reply\n", vars->id);
+    task_bpd_asyn_call(1, task, wait_reply);
+    task_bpd_cancel_check(task);
+
+    el_timer_stop(&vars->timeout);
+    printf("request %u: reply %d\n", vars->id, task->ret_val.s32);
+
+    bpd_end();
+
+    if (task_is_cancelled(task))
+    {
+        printf("request %u: cancelled\n", vars->id);
+    }
+
+    task_asyn_return(task);
+}
+
+/* Client task: sends requests one by one */
+/* 客户端任务：逐个发送请求 */
+static void client(task_t *task, event_t *ev)
+{
+    uint8_t *bpd = TASK_BPD(task);
+    uint32_t *id = task_asyn_vars_get(task, sizeof(uint32_t));
+
+    bpd_begin(1);
+
+    for (*id = 1; ; (*id)++)
+    {
+        task_bpd_asyn_call(1, task, request, *id);
+        task_bpd_cancel_check(task);
+    }
+
+    bpd_end();
+
+    task_asyn_return(task);
+}
+
+/* Watcher task: waits for configuration reloads */
+/* 监视任务：等待配置重载 */
+static void watcher(task_t *task, event_t *ev)
+{
+    uint8_t *bpd = TASK_BPD(task);
+    struct vars
+    {
+        task_cancel_reg_t reg;
+        uint32_t reloads;
+    } *vars = task_asyn_vars_get(task, sizeof(*vars));
+
+    bpd_begin(1);
+
+    for (vars->reloads = 0; ; vars->reloads++)
+    {
+        acond_wait(&reload, &task->event);
+        task_cancel_reg_acond(task, &vars->reg, &reload, &task->event);
+        bpd_yield(1);
+        task_bpd_cancel_check(task);
+
+        /* the wait completed, withdraw the registration before waiting again */
+        /* 等待已完成，再次等待前移除登记 */
+        task_cancel_unreg(task, &vars->reg);
+        printf("watcher: reload %u\n", vars->reloads + 1);
+    }
+
+    bpd_end();
+
+    printf("watcher: cancelled after %u reloads\n", vars->reloads);
+
+    task_asyn_return(task);
+}
+
+/* Task end callback */
+/* 任务结束回调 */
+static void on_task_end(void *ctx, event_t *ev)
+{
+    printf("%s ended\n", (const char *)ctx);
+}
+
+/* Drive the demo: reply and reload once, then cancel both tasks */
+/* 驱动示例：应答与重载各一次，然后取消两个任务 */
+static void on_timer(void *ctx, event_t *ev)
+{
+    task_t **tasks = (task_t **)ctx;
+    static uint32_t step;
+
+    switch (step++)
+    {
+    case 0:
+        future_resolve_s32(&reply, 200);
+        acond_broadcast(&reload);
+        break;
+
+    case 1:
+        /* the second request and the watcher are blocked again */
+        /* 第二个请求与监视任务再次阻塞 */
+        printf("cancel client: %d\n", task_cancel(tasks[0]));
+        printf("cancel watcher: %d\n", task_cancel(tasks[1]));
+        return;
+    }
+
+    el_timer_start_ms((timer_event_t *)ev, 100);
+}
+
+int main()
+{
+    event_t client_end_ev;
+    event_t watcher_end_ev;
+    timer_event_t timer;
+    task_t *tasks[2];
+
+    time_nclk_t due, now;
+    time_ms_t timeout;
+
+    TASK_DEFINE(client_task, 256, LOWER_GROUP_PRIORITY);
+    TASK_DEFINE(watcher_task, 128, LOWER_GROUP_PRIORITY);
+
+    tasks[0] = &client_task;
+    tasks[1] = &watcher_task;
+
+    event_init(&client_end_ev, on_task_end, "client", LOWER_GROUP_PRIORITY);
+    task_end_wait(&client_task, &client_end_ev);
+    event_init(&watcher_end_ev, on_task_end, "watcher", LOWER_GROUP_PRIORITY);
+    task_end_wait(&watcher_task, &watcher_end_ev);
+
+    task_start(&client_task, client);
+    task_start(&watcher_task, watcher);
+
+    timer_init(&timer, on_timer, tasks, LOWER_GROUP_PRIORITY);
+    el_timer_start_ms(&timer, 100);
+
+    while (1)
+    {
+        due = el_schedule();
+
+        if (task_is_end(&client_task) && task_is_end(&watcher_task) && !el_have_imm_event())
+        {
+            break;
+        }
+
+        now = time_nclk_get();
+        timeout = due < now ? 0 : time_nclk_to_us(due - now);
+        timeout = timeout > INT32_MAX ? INT32_MAX : timeout;
+
+        usleep((int)timeout);
+    }
+
+    /* every wait has been withdrawn */
+    /* 全部等待均已撤销 */
+    printf("reply waiters %d, reload waiters %d\n",
+            acond_have_waiters(&reply.waiters), acond_have_waiters(&reload));
+
+    return 0;
+}
@@ -0,0 +1,182 @@
+﻿/*
+ * Copyright (C) 2018-2019 xiaoliang<1296283984@qq.com>.
+ */
+
+/* Structured concurrency: a failed child cancels its siblings, the parent joins them */
+/* 结构化并发：失败的子任务取消其兄弟任务，父任务等待它们结束 */
+
+/* gcc -O2 -DCONFIG_TASK_CANCEL -o nursery nursery.c atask_port.c ../lib/atask.c */
+/* ./nursery */
+
+#include "../lib/atask.h"
+#include <stdio.h>
+#include <unistd.h>
+
+#ifndef CONFIG_TASK_CANCEL
+#error "build with -DCONFIG_TASK_CANCEL"
+#endif
+
+#define CHILD_STACK_SIZE    128
+#define CHILD_NUMS          3
+
+/* blocks of the children and their stacks */
+/* 子任务及其栈的块 */
+static uint8_t child_buff[TASK_NURSERY_BUFF_SIZE(CHILD_STACK_SIZE, CHILD_NUMS)];
+static slab_t child_slab;
+
+/* Timer of a child, resumes the child */
+/* 子任务的定时器，恢复子任务 */
+static void on_child_timer(void *ctx, event_t *ev)
+{
+    (void)ev;
+    el_event_post(&((task_t *)ctx)->event);
+}
+
+/* Child task: works for delay_ms, then fails with err if err is not 0 */
+/* 子任务：工作delay_ms，err非0时以err失败 */
+static void child(task_t *task, event_t *ev, uint32_t id, uint32_t delay_ms, int32_t err)
+{
+    uint8_t *bpd = TASK_BPD(task);
+    struct vars
+    {
+        timer_event_t timer;
+        task_cancel_reg_t reg;
+        uint32_t id;
+        int32_t err;
+    } *vars = task_asyn_vars_get(task, sizeof(*vars));
+
+    (void)ev;
+
+    bpd_begin(1);
+
+    vars->id = id;
+    vars->err = err;
+
+    timer_init(&vars->timer, on_child_timer, task, LOWER_GROUP_PRIORITY);
+    el_timer_start_ms(&vars->timer, delay_ms);
+    task_cancel_reg_timer(task, &vars->reg, &vars->timer);
+    bpd_yield(1);
+    task_bpd_cancel_check(task);
+
+    if (vars->err != 0)
+    {
+        printf("child %u: failed %d\n", vars->id, vars->err);
+        task_nursery_child_fail(task, vars->err);
+    }
+    else
+    {
+        printf("child %u: done\n", vars->id);
+    }
+
+    bpd_end();
+
+    if (task_is_cancelled(task))
+    {
+        printf("child %u: cancelled\n", vars->id);
+    }
+
+    task_asyn_return(task);
+}
+
+/* Parent task: runs a round of children, then a round cancelled from outside */
+/* 父任务：运行一轮子任务，然后运行一轮被外部取消的子任务 */
+static void parent(task_t *task, event_t *ev)
+{
+    uint8_t *bpd = TASK_BPD(task);
+    struct vars
+    {
+        task_nursery_t nursery;
+        task_t *child;
+    } *vars = task_asyn_vars_get(task, sizeof(*vars));
+
+    (void)ev;
+
+    bpd_begin(2);
+
+    /* round 1: child 2 fails, children 1 and 3 are cancelled */
+    /* 第一轮：子任务2失败，子任务1与3被取消 */
+    task_nursery_init(&vars->nursery, task, &child_slab);
+    task_nursery_spawn(&vars->nursery, vars->child, child, 1, 1000, 0);
+    task_nursery_spawn(&vars->nursery, vars->child, child, 2, 100, -5);
+    task_nursery_spawn(&vars->nursery, vars->child, child, 3, 1000, 0);
+    task_bpd_nursery_join(1, task, &vars->nursery);
+    printf("round 1: joined, err %d\n", task_nursery_err_get(&vars->nursery));
+
+    /* the nursery is closed, withdraw its registration before opening the next one */
+    /* nursery已关闭，打开下一个之前移除其登记 */
+    task_cancel_unreg(task, &vars->nursery.cancel_reg);
+
+    /* round 2: the parent is cancelled by the main loop, so are the children */
+    /* 第二轮：父任务被主循环取消，子任务随之取消 */
+    task_nursery_init(&vars->nursery, task, &child_slab);
+    task_nursery_spawn(&vars->nursery, vars->child, child, 4, 1000, 0);
+    task_nursery_spawn(&vars->nursery, vars->child, child, 5, 1000, 0);
+    task_bpd_nursery_join(2, task, &vars->nursery);
+    printf("round 2: joined, err %d, cancelled %d\n",
+            task_nursery_err_get(&vars->nursery), task_is_cancelled(task));
+
+    bpd_end();
+
+    task_asyn_return(task);
+}
+
+/* Task end callback */
+/* 任务结束回调 */
+static void on_task_end(void *ctx, event_t *ev)
+{
+    (void)ev;
+    printf("%s ended\n", (const char *)ctx);
+}
+
+/* Cancel the parent in round 2 */
+/* 在第二轮中取消父任务 */
+static void on_timer(void *ctx, event_t *ev)
+{
+    (void)ev;
+    printf("cancel parent: %d\n", task_cancel((task_t *)ctx));
+}
+
+int main()
+{
+    event_t parent_end_ev;
+    timer_event_t timer;
+
+    time_nclk_t due, now;
+    time_ms_t timeout;
+
+    TASK_DEFINE(parent_task, 256, LOWER_GROUP_PRIORITY);
+
+    slab_init(&child_slab, child_buff, sizeof(child_buff), TASK_NURSERY_BLK_SIZE(CHILD_STACK_SIZE));
+
+    event_init(&parent_end_ev, on_task_end, "parent", LOWER_GROUP_PRIORITY);
+    task_end_wait(&parent_task, &parent_end_ev);
+
+    task_start(&parent_task, parent);
+
+    /* round 1 ends after 100ms, round 2 is cancelled at 300ms */
+    /* 第一轮在100ms后结束，第二轮在300ms时被取消 */
+    timer_init(&timer, on_timer, &parent_task, LOWER_GROUP_PRIORITY);
+    el_timer_start_ms(&timer, 300);
+
+    while (1)
+    {
+        due = el_schedule();
+
+        if (task_is_end(&parent_task) && !el_have_imm_event())
+        {
+            break;
+        }
+
+        now = time_nclk_get();
+        timeout = due < now ? 0 : time_nclk_to_us(due - now);
+        timeout = timeout > INT32_MAX ? INT32_MAX : timeout;
+
+        usleep((int)timeout);
+    }
+
+    /* every child block has been returned */
+    /* 全部子任务块均已归还 */
+    printf("child blocks in use %u\n", slab_used_get(&child_slab));
+
+    return 0;
+}
@@ -11,6 +11,7 @@
 /* #define TASK_ASSERT(expr)   do { if (!(expr)) {printf("ERROR: stack overflow!!\n"); abort();} } while(0) */
 
 #include "../lib/atask.h"
+#include "../lib/arena.h"
 
 struct iocp_evt_s
 {
@@ -105,23 +106,46 @@ void iocp_atask_run(HANDLE iocp)
 
 /* Http client request task stack size */
 /* Http客户端请求任务的栈大小 */
-#define HTTP_CLIENT_REQUST_TASK_STACK_SIZE  (256 + 3072)
+#define HTTP_CLIENT_REQUST_TASK_STACK_SIZE  (256 + 2560)
 
 /* Maximum number of Http clients */
 /* Http客户端最大数量 */
 #define HTTP_CLIENT_MAX_NUMS                30000
 
+/* Timeout of waiting for a free client task, the new client is dropped on timeout */
+/* 等待空闲客户端任务的超时时间，超时后丢弃新的客户端 */
+#define HTTP_CLIENT_ALLOC_TIMEOUT_MS        1000
+
+/* Http accept task stack size, holds the asynchronous variables of
+   http_accept_task_handler (344 bytes on 64-bit builds) with some margin */
+/* Http接受连接任务的栈大小，容纳http_accept_task_handler的异步变量
+   （64位编译时为344字节）并留有余量 */
+#define HTTP_ACCEPT_TASK_STACK_SIZE         384
+
 #define SERVER_STRING "Server: libatask httpd 1.0\r\n"
 
-struct http_task_with_stack_s
-{
-    task_t task;
-    event_t free_ev;
-    uint8_t stack[HTTP_CLIENT_REQUST_TASK_STACK_SIZE];
-};
+static uint8_t http_client_tasks_buff[TASK_POOL_BUFF_SIZE(HTTP_CLIENT_REQUST_TASK_STACK_SIZE, HTTP_CLIENT_MAX_NUMS)];
+static task_pool_t http_client_tasks;
+
+/* Size of the url field of a request */
+/* 请求的url字段大小 */
+#define HTTP_CLIENT_URL_SIZE                400
+
+/* Worst case size of the request path: "wwwroot" + url + "index.html" + "/index.html" */
+/* 请求路径的最大大小："wwwroot" + url + "index.html" + "/index.html" */
+#define HTTP_CLIENT_PATH_SIZE               (sizeof("wwwroot") + HTTP_CLIENT_URL_SIZE + sizeof("index.html") + sizeof("/index.html"))
+
+/* Chunk size of the per-request arena, holds the arena itself and the worst case path */
+/* 每个请求的arena的chunk大小，容纳arena自身以及最大的路径 */
+#define HTTP_CLIENT_ARENA_CHUNK_SIZE        (ARENA_CHUNK_HDR_SIZE + ALIGN_UP(sizeof(arena_t)) + ALIGN_UP(HTTP_CLIENT_PATH_SIZE))
 
-static uint8_t http_client_tasks_slab_buff[HTTP_CLIENT_REQUST_TASK_STACK_SIZE * HTTP_CLIENT_MAX_NUMS + sizeof(slab_t)];
-static slab_t *http_client_tasks_slab = NULL;
+/* Number of arena chunks shared by the clients, 
+   a chunk is only held while a request is being answered */
+/* 客户端共享的arena chunk个数，chunk只在应答请求期间被持有 */
+#define HTTP_CLIENT_ARENA_CHUNK_NUMS        (HTTP_CLIENT_MAX_NUMS / 8)
+
+static uint8_t http_client_arena_slab_buff[HTTP_CLIENT_ARENA_CHUNK_SIZE * HTTP_CLIENT_ARENA_CHUNK_NUMS + sizeof(void *)];
+static slab_t http_client_arena_slab;
 
 /* Get data from the client */
 /* 从客户端获取数据 */
@@ -270,6 +294,16 @@ SERVER_STRING
 "<body><p>HTTP request method not supported.\r\n"
 "</p></body></html>\r\n";
 
+static const char http_503_rsp_text[] = 
+"HTTP/1.0 503 Service Unavailable\r\n"
+SERVER_STRING
+"Content-Type: text/html\r\n"
+"\r\n"
+"<html><head><title>Service Unavailable\r\n"
+"</title></head>\r\n"
+"<body><p>The server is too busy to respond to your request.\r\n"
+"</p></body></html>\r\n";
+
 static const char http_404_rsp_text[] = 
 "HTTP/1.0 404 NOT FOUND\r\n"
 SERVER_STRING
@@ -390,7 +424,7 @@ void http_client_send(task_t *task, event_t *ev, SOCKET _cli_sock, const void *_
 
 /* client requst processing task handler */
 /* 客户端请求处理任务函数 */
-void http_client_requst_task_handler(task_t *task, event_t *ev, SOCKET _cli_sock, const struct sockaddr_in *_client_addr)
+void http_client_requst_task_handler(task_t *task, event_t *ev, SOCKET _cli_sock, uint32_t _client_ip, uint32_t _client_port)
 {
     uint8_t *bpd = TASK_BPD(task);
     struct vars
@@ -399,8 +433,9 @@ void http_client_requst_task_handler(task_t *task, event_t *ev, SOCKET _cli_sock
         struct sockaddr_in client_addr;
         uint8_t buf[2048];
         char method[6];
-        char url[400];
-        char path[512];
+        char url[HTTP_CLIENT_URL_SIZE];
+        char *path;
+        arena_t *arena;
         char *query_string;
         uint32_t data_size;
         uint8_t cgi;
@@ -419,12 +454,15 @@ void http_client_requst_task_handler(task_t *task, event_t *ev, SOCKET _cli_sock
 
     /* coroutine begin */
     /* 协程开始 */
-    bpd_begin(14);
+    bpd_begin(15);
 
     /* Save incoming parameters to asynchronous variables */
     /* 保存传入的参数至异步变量 */
     vars->cli_sock = _cli_sock;
-    vars->client_addr = *_client_addr;
+    memset(&vars->client_addr, 0, sizeof(vars->client_addr));
+    vars->client_addr.sin_family = AF_INET;
+    vars->client_addr.sin_addr.s_addr = _client_ip;
+    vars->client_addr.sin_port = (u_short)_client_port;
     vars->header_end = 0;
 
     while (1)
@@ -659,8 +697,28 @@ void http_client_requst_task_handler(task_t *task, event_t *ev, SOCKET _cli_sock
         }
     }
 
-    /* Generate Path */
-    /* 生成Path */
+    /* Temporaries of the request are allocated from the arena, 
+       the arena is destroyed when the task ends */
+    /* 请求的临时数据从arena分配，任务结束时销毁arena */
+    vars->arena = arena_create(&http_client_arena_slab);
+    if (vars->arena != NULL)
+    {
+        arena_task_bind(vars->arena, task);
+
+        /* Generate Path, leave room for appending index.html */
+        /* 生成Path，预留追加index.html的空间 */
+        vars->path = (char *)arena_alloc(vars->arena, 
+                                         sizeof("wwwroot") + strlen(vars->url) + sizeof("index.html") + sizeof("/index.html"));
+    }
+    if (vars->arena == NULL || vars->path == NULL)
+    {
+        task_bpd_asyn_call(15, task, http_client_send,
+                            vars->cli_sock,
+                            http_503_rsp_text,
+                            sizeof(http_503_rsp_text) - 1);
+
+        goto client_close;
+    }
     sprintf(vars->path, "wwwroot%s", vars->url);
     if (vars->path[strlen(vars->path) - 1] == '/')
     {
@@ -836,19 +894,12 @@ client_close:
     task_asyn_return(task);
 }
 
-static void on_task_end(void *task, event_t *ev)
-{
-    /* free the task */
-    /* 释放task */
-    slab_free(http_client_tasks_slab, task);
-}
-
 /* Accept task handler */
 /* Accept任务函数 */
 void http_accept_task_handler(task_t *task, event_t *ev)
 {
     uint8_t *bpd = TASK_BPD(task);
-    struct http_task_with_stack_s *task_with_stack;
+    task_t *client_task;
     DWORD dwError;
 
     /* Get or assign asynchronous variables from the task stack.
@@ -865,7 +916,7 @@ void http_accept_task_handler(task_t *task, event_t *ev)
         struct sockaddr_in *clientAddr, *localAddr;
         int clientAddrLen, localAddrLen;
         timer_event_t timer;
-        slab_alloc_event_t alloc_ev;
+        slab_timed_alloc_event_t alloc_ev;
     } *vars = (struct vars *)task_asyn_vars_get(task, sizeof(*vars));
 
     /* coroutine begin */
@@ -887,13 +938,24 @@ void http_accept_task_handler(task_t *task, event_t *ev)
 
     /* Initialize slab alloc event */
     /* 初始化slab分配器事件 */
-    slab_alloc_event_init_inherit(&vars->alloc_ev, &task->event);
+    slab_timed_alloc_event_init_inherit(&vars->alloc_ev, &task->event);
+
+    /* Initialize http client task pool, tasks are handed out lazily,
+       so only the pages of the tasks actually used are touched */
+    /* 初始化http客户端任务池，任务按需分配，
+       只有实际使用过的task所在的页会被访问 */
+    task_pool_init(&http_client_tasks,
+                    http_client_tasks_buff,
+                    sizeof(http_client_tasks_buff),
+                    HTTP_CLIENT_REQUST_TASK_STACK_SIZE,
+                    EVENT_PRIORITY(&task->event));
 
-    /* Initialize http client slab */
-    /* 初始化http客户端slab */
-    http_client_tasks_slab = slab_create(http_client_tasks_slab_buff, 
-                                sizeof(http_client_tasks_slab_buff), 
-                                sizeof(struct http_task_with_stack_s));
+    /* Initialize the slab of the per-request arenas */
+    /* 初始化每个请求的arena所用的slab */
+    slab_init_lazy(&http_client_arena_slab,
+                    http_client_arena_slab_buff,
+                    sizeof(http_client_arena_slab_buff),
+                    HTTP_CLIENT_ARENA_CHUNK_SIZE);
 
     while (1)
     {
@@ -971,37 +1033,46 @@ void http_accept_task_handler(task_t *task, event_t *ev)
             continue;
         }
 
-        /* Alloc a task from the slab*/
-        /* 从slab分配一个task */
-        task_with_stack = (struct http_task_with_stack_s *)slab_alloc(http_client_tasks_slab);
-        while (task_with_stack == NULL)
+        /* Process the client Http request with a task from the task pool,
+           the task returns to the pool when it ends.
+           The task runs on the next scheduling pass, so the next connection
+           is accepted without waiting for this request to reach its first I/O,
+           the client address is passed by value because the AcceptEx buffer is reused */
+        /* 使用任务池中的task处理该客户端Http请求，
+           task结束时归还到任务池。
+           task在下一次调度时运行，因此无需等待该请求运行到首次I/O即可接受下一个连接，
+           由于AcceptEx缓冲区将被复用，客户端地址按值传递 */
+        task_pool_spawn_deferred(&http_client_tasks,
+                                client_task,
+                                http_client_requst_task_handler,
+                                vars->cli_sock,
+                                vars->clientAddr->sin_addr.s_addr,
+                                vars->clientAddr->sin_port);
+        if (client_task == NULL)
         {
-            /* Waiting for slab to be available */
-            /* 等待slab可用 */
-            slab_wait(http_client_tasks_slab, &vars->alloc_ev);
+            /* Waiting for a client task to be available */
+            /* 等待客户端任务可用 */
+            task_pool_wait_timeout(&http_client_tasks, &vars->alloc_ev, HTTP_CLIENT_ALLOC_TIMEOUT_MS);
             bpd_yield(3);
 
-            task_with_stack = (struct http_task_with_stack_s *)vars->alloc_ev.mem_blk;
-        }
+            client_task = task_pool_task_get(&http_client_tasks, &vars->alloc_ev.alloc_event);
 
-        /* Initialize the http client request task */
-        /* 初始化http客户端请求task */
-        task_init(&task_with_stack->task, 
-                    task_with_stack->stack, 
-                    sizeof(task_with_stack->stack),
-                    EVENT_PRIORITY(&task->event));
+            /* No client task is available, drop this client to shed load */
+            /* 没有可用的客户端任务，丢弃该客户端以降低负载 */
+            if (client_task == NULL)
+            {
+                printf("Too many clients, drop the new client!\n");
 
-        /* The listening task ends and the used memory is released in on_task_end */
-        /* 监听任务结束，并在on_task_end释放使用的内存 */
-        event_init(&task_with_stack->free_ev, on_task_end, task_with_stack, MIDDLE_GROUP_PRIORITY);
-        task_end_wait(&task_with_stack->task, &task_with_stack->free_ev);
-
-        /* Process the client Http request */
-        /* 处理该客户端Http请求 */
-        task_start(&task_with_stack->task, 
-                    http_client_requst_task_handler, 
-                    vars->cli_sock,
-                    vars->clientAddr);
+                closesocket(vars->cli_sock);
+                continue;
+            }
+
+            task_start_deferred(client_task,
+                                http_client_requst_task_handler,
+                                vars->cli_sock,
+                                vars->clientAddr->sin_addr.s_addr,
+                                vars->clientAddr->sin_port);
+        }
     }
 
     /* coroutine end */
@@ -1009,6 +1080,37 @@ void http_accept_task_handler(task_t *task, event_t *ev)
     bpd_end();
 }
 
+#ifdef CONFIG_TASK_STACK_PROFILE
+
+/* Print the task stack profile periodically, used to right-size HTTP_CLIENT_REQUST_TASK_STACK_SIZE */
+/* 定期打印任务栈分析，用于确定合适的HTTP_CLIENT_REQUST_TASK_STACK_SIZE */
+static void on_stack_profile_timer(void *ctx, event_t *ev)
+{
+    const task_stack_func_prof_t *prof;
+    uint32_t i;
+
+    printf("task stack: size %u, max %u, p50 %u, p99 %u, ended tasks %u\n",
+            (uint32_t)HTTP_CLIENT_REQUST_TASK_STACK_SIZE,
+            task_stack_profile_max(),
+            task_stack_profile_percentile(50),
+            task_stack_profile_percentile(99),
+            task_stack_profile.task_nums);
+
+    for (i = 0; i < CONFIG_TASK_STACK_PROFILE_FUNCS; i++)
+    {
+        prof = task_stack_profile_func_get(i);
+        if (prof != NULL)
+        {
+            printf("    func %p: calls %u, vars %u, entry depth %u\n",
+                    (void *)prof->func, prof->calls, prof->vars_peak, prof->entry_depth_peak);
+        }
+    }
+
+    el_timer_start_ms((timer_event_t *)ev, 10000);
+}
+
+#endif /* CONFIG_TASK_STACK_PROFILE */
+
 int main()
 {
     WSADATA wsaData;
@@ -1016,7 +1118,10 @@ int main()
     GUID GuidAcceptEx = WSAID_ACCEPTEX;
     GUID GuidGetAcceptExSockAddrs = WSAID_GETACCEPTEXSOCKADDRS;
     DWORD dwBytes;
-    TASK_DEFINE(http_accept_task, 280, MIDDLE_GROUP_PRIORITY);
+    TASK_DEFINE(http_accept_task, HTTP_ACCEPT_TASK_STACK_SIZE, MIDDLE_GROUP_PRIORITY);
+#ifdef CONFIG_TASK_STACK_PROFILE
+    timer_event_t stack_profile_timer;
+#endif
 
     WSAStartup(MAKEWORD(2,2), &wsaData);
 
@@ -1121,6 +1226,13 @@ int main()
     /* 启动http accept任务 */
     task_start(&http_accept_task, http_accept_task_handler);
 
+#ifdef CONFIG_TASK_STACK_PROFILE
+    /* report the task stack profile every 10 seconds */
+    /* 每10秒报告一次任务栈分析 */
+    timer_init(&stack_profile_timer, on_stack_profile_timer, NULL, LOWER_GROUP_PRIORITY);
+    el_timer_start_ms(&stack_profile_timer, 10000);
+#endif
+
     /* Run the atask event loop with IOCP */
     /* 运行带IOCP的atask事件循环 */
     iocp_atask_run(s_iocp);
@@ -0,0 +1,469 @@
+﻿/*
+ * Copyright (C) 2018-2019 xiaoliang<1296283984@qq.com>.
+ */
+
+#ifndef __LIB_ARENA_H__
+#define __LIB_ARENA_H__
+
+#include "atask.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************************************************
+ *@description:
+ ***Arena (bump) allocator drawing chunks from a slab.
+ ***Memory is allocated by moving a pointer inside the current chunk,
+ ***a new chunk is taken from the slab when the current one is full.
+ ***Memory is not freed one by one, arena_release returns everything
+ ***allocated after a mark and arena_reset returns everything,
+ ***the chunks go back to the slab in one splice.
+ ***
+ ***An arena can be tied to a task with arena_task_bind,
+ ***it is destroyed when the task ends.
+ *********************************************************
+ *@说明：
+ ***从slab中获取chunk的arena（指针碰撞）分配器。
+ ***在当前chunk内移动指针进行分配，当前chunk用尽时从slab中取新的chunk。
+ ***内存不逐个释放，arena_release归还标记之后分配的全部内存，
+ ***arena_reset归还全部内存，chunk一次拼接回slab。
+ ***
+ ***可使用arena_task_bind将arena与任务绑定，任务结束时销毁arena
+ *********************************************************/
+
+
+/*********************************************************
+ *@type description:
+ *
+ *[arena_mark_t]: position of the arena, see arena_mark
+ *********************************************************
+ *@类型说明：
+ *
+ *[arena_mark_t]：arena的位置，参见arena_mark
+ *********************************************************/
+typedef struct arena_mark_s
+{
+    /* current chunk, NULL if the arena has no chunk */
+    /* 当前chunk，arena没有chunk时为NULL */
+    slist_node_t *chunk;
+
+    /* allocation pointer in the current chunk */
+    /* 当前chunk中的分配指针 */
+    uint8_t *cur;
+
+    /* number of chunks */
+    /* chunk个数 */
+    uint32_t chunk_nums;
+} arena_mark_t;
+
+
+/*********************************************************
+ *@type description:
+ *
+ *[arena_t]: arena allocator
+ *********************************************************
+ *@类型说明：
+ *
+ *[arena_t]：arena分配器
+ *********************************************************/
+typedef struct arena_s
+{
+    /* slab providing the chunks, the block size of the slab is the chunk size */
+    /* 提供chunk的slab，slab的块大小即chunk大小 */
+    slab_t *slab;
+
+    /* chunks from the oldest to the current one, linked by the first word of the chunk */
+    /* 从最早到当前的chunk，由chunk的首字链接 */
+    fifo_t chunks;
+
+    /* allocation pointer */
+    /* 分配指针 */
+    uint8_t *cur;
+
+    /* end of the current chunk */
+    /* 当前chunk的结尾 */
+    uint8_t *end;
+
+    /* number of chunks */
+    /* chunk个数 */
+    uint32_t chunk_nums;
+
+    /* position restored by arena_reset, holds the arena itself if created by arena_create */
+    /* arena_reset恢复的位置，由arena_create创建时包含arena自身 */
+    arena_mark_t base;
+
+    /* task end event of arena_task_bind */
+    /* arena_task_bind的任务结束事件 */
+    event_t task_end_ev;
+} arena_t;
+
+/* Size of the chunk header */
+/* chunk头部大小 */
+#define ARENA_CHUNK_HDR_SIZE    ALIGN_UP(sizeof(slist_node_t))
+
+/* Take a chunk from the slab as the current chunk */
+/* 从slab中取一个chunk作为当前chunk */
+static inline bool _arena_private_grow(arena_t *arena)
+{
+    slist_node_t *chunk = (slist_node_t *)slab_alloc(arena->slab);
+
+    if (chunk == NULL)
+    {
+        return false;
+    }
+
+    fifo_push(&arena->chunks, chunk);
+    arena->chunk_nums++;
+    arena->cur = (uint8_t *)chunk + ARENA_CHUNK_HDR_SIZE;
+    arena->end = (uint8_t *)chunk + slab_blk_size_get(arena->slab);
+
+    return true;
+}
+
+
+/*********************************************************
+ *@brief:
+ ***initialize an arena, the arena takes no chunk until the first allocation
+ *
+ *@parameter:
+ *[arena]: arena
+ *[slab]: slab providing the chunks
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***初始化arena，在第一次分配前arena不占用chunk
+ *
+ *@参数：
+ *[arena]：arena
+ *[slab]：提供chunk的slab
+ **********************************************************/
+static inline void arena_init(arena_t *arena, slab_t *slab)
+{
+    arena->slab = slab;
+    fifo_init(&arena->chunks);
+    arena->cur = NULL;
+    arena->end = NULL;
+    arena->chunk_nums = 0;
+    arena->base.chunk = NULL;
+    arena->base.cur = NULL;
+    arena->base.chunk_nums = 0;
+    event_init(&arena->task_end_ev, (event_cb)NULL_CB, arena, 0);
+}
+
+
+/*********************************************************
+ *@brief:
+ ***create an arena inside its first chunk, no storage is needed for the arena,
+ ***destroy it with arena_destroy
+ *
+ *@parameter:
+ *[slab]: slab providing the chunks
+ *
+ *@return value:
+ *[NULL]: the slab is exhausted
+ *[other]: arena
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***在第一个chunk内创建arena，arena无需额外的存储，
+ ***使用arena_destroy销毁
+ *
+ *@参数：
+ *[slab]：提供chunk的slab
+ *
+ *@返回值：
+ *[NULL]：slab已耗尽
+ *[其他]：arena
+ **********************************************************/
+static inline arena_t *arena_create(slab_t *slab)
+{
+    slist_node_t *chunk = (slist_node_t *)slab_alloc(slab);
+    arena_t *arena;
+
+    if (chunk == NULL)
+    {
+        return NULL;
+    }
+
+    arena = (arena_t *)((uint8_t *)chunk + ARENA_CHUNK_HDR_SIZE);
+    arena_init(arena, slab);
+
+    fifo_push(&arena->chunks, chunk);
+    arena->chunk_nums = 1;
+    arena->cur = (uint8_t *)arena + ALIGN_UP(sizeof(arena_t));
+    arena->end = (uint8_t *)chunk + slab_blk_size_get(slab);
+
+    arena->base.chunk = chunk;
+    arena->base.cur = arena->cur;
+    arena->base.chunk_nums = 1;
+
+    return arena;
+}
+
+
+/*********************************************************
+ *@brief:
+ ***allocate memory from the arena, the memory is aligned to the pointer size
+ *
+ *@parameter:
+ *[arena]: arena
+ *[size]: size of the memory, no more than the chunk size minus ARENA_CHUNK_HDR_SIZE
+ *
+ *@return value:
+ *[NULL]: the size is too large or the slab is exhausted
+ *[other]: memory
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***从arena分配内存，内存按指针大小对齐
+ *
+ *@参数：
+ *[arena]：arena
+ *[size]：内存大小，不超过chunk大小减去ARENA_CHUNK_HDR_SIZE
+ *
+ *@返回值：
+ *[NULL]：大小过大或slab已耗尽
+ *[其他]：内存
+ **********************************************************/
+static inline void *arena_alloc(arena_t *arena, size_t size)
+{
+    void *mem;
+
+    size = ALIGN_UP(size);
+
+    if ((size_t)(arena->end - arena->cur) < size)
+    {
+        if (size > slab_blk_size_get(arena->slab) - ARENA_CHUNK_HDR_SIZE
+         || !_arena_private_grow(arena))
+        {
+            return NULL;
+        }
+    }
+
+    mem = arena->cur;
+    arena->cur += size;
+
+    return mem;
+}
+
+
+/*********************************************************
+ *@brief:
+ ***record the current position of the arena
+ *
+ *@parameter:
+ *[arena]: arena
+ *[mark]: output position
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***记录arena的当前位置
+ *
+ *@参数：
+ *[arena]：arena
+ *[mark]：输出的位置
+ **********************************************************/
+static inline void arena_mark(arena_t *arena, arena_mark_t *mark)
+{
+    mark->chunk = arena->chunk_nums ? FIFO_TAIL(&arena->chunks) : NULL;
+    mark->cur = arena->cur;
+    mark->chunk_nums = arena->chunk_nums;
+}
+
+
+/*********************************************************
+ *@brief:
+ ***release all the memory allocated after the mark,
+ ***the chunks taken after the mark return to the slab in one splice
+ *
+ *@contract:
+ ***1. the mark is recorded by arena_mark after arena_reset and
+ ***   not released by an earlier mark
+ *
+ *@parameter:
+ *[arena]: arena
+ *[mark]: position recorded by arena_mark
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***释放标记之后分配的全部内存，
+ ***标记之后取得的chunk一次拼接回slab
+ *
+ *@约定：
+ ***1、标记由arena_mark在arena_reset之后记录，且未被更早的标记释放
+ *
+ *@参数：
+ *[arena]：arena
+ *[mark]：由arena_mark记录的位置
+ **********************************************************/
+static inline void arena_release(arena_t *arena, const arena_mark_t *mark)
+{
+    slist_node_t *head = SLIST_HEAD(FIFO_LIST(&arena->chunks));
+    slist_node_t *first;
+    slist_node_t *last = FIFO_TAIL(&arena->chunks);
+
+    if (arena->chunk_nums > mark->chunk_nums)
+    {
+        /* detach the chunks after the mark and return them at once */
+        /* 取下标记之后的chunk并一次归还 */
+        first = mark->chunk ? SLIST_NODE_NEXT(mark->chunk) : SLIST_NODE_NEXT(head);
+        if (mark->chunk)
+        {
+            mark->chunk->next = head;
+            arena->chunks.tail = mark->chunk;
+        }
+        else
+        {
+            fifo_init(&arena->chunks);
+        }
+
+        slab_free_chain(arena->slab, first, last, arena->chunk_nums - mark->chunk_nums);
+        arena->chunk_nums = mark->chunk_nums;
+    }
+
+    arena->cur = mark->cur;
+    arena->end = mark->chunk ? (uint8_t *)mark->chunk + slab_blk_size_get(arena->slab) : NULL;
+}
+
+
+/*********************************************************
+ *@brief:
+ ***release all the memory of the arena,
+ ***the chunks return to the slab in one splice
+ *
+ *@parameter:
+ *[arena]: arena
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***释放arena的全部内存，chunk一次拼接回slab
+ *
+ *@参数：
+ *[arena]：arena
+ **********************************************************/
+static inline void arena_reset(arena_t *arena)
+{
+    arena_release(arena, &arena->base);
+}
+
+
+/*********************************************************
+ *@brief:
+ ***destroy the arena, all the chunks return to the slab,
+ ***including the chunk holding the arena created by arena_create
+ *
+ *@parameter:
+ *[arena]: arena
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***销毁arena，全部chunk归还slab，
+ ***包括由arena_create创建的arena所在的chunk
+ *
+ *@参数：
+ *[arena]：arena
+ **********************************************************/
+static inline void arena_destroy(arena_t *arena)
+{
+    slab_t *slab = arena->slab;
+    slist_node_t *chunk = arena->base.chunk;
+
+    arena_reset(arena);
+
+    if (chunk)
+    {
+        slab_free(slab, chunk);
+    }
+}
+
+/* Destroy the arena when the bound task ends */
+/* 绑定的任务结束时销毁arena */
+static inline void _arena_private_on_task_end(void *ctx, event_t *e)
+{
+    (void)e;
+
+    arena_destroy((arena_t *)ctx);
+}
+
+
+/*********************************************************
+ *@brief:
+ ***tie the arena to a task, the arena is destroyed after the task ends
+ *
+ *@contract:
+ ***1. the arena is not in the asynchronous variables of the task
+ ***2. the arena is bound to one task at a time
+ *
+ *@parameter:
+ *[arena]: arena
+ *[task]: task
+ *
+ *@return value:
+ *[true]: bound successfully
+ *[false]: the arena is already bound
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***将arena与任务绑定，任务结束后销毁arena
+ *
+ *@约定：
+ ***1、arena不位于任务的异步变量中
+ ***2、arena同一时间只绑定一个任务
+ *
+ *@参数：
+ *[arena]：arena
+ *[task]：任务
+ *
+ *@返回值：
+ *[true]：绑定成功
+ *[false]：arena已被绑定
+ **********************************************************/
+static inline bool arena_task_bind(arena_t *arena, task_t *task)
+{
+    if (!slist_node_is_del(EVENT_NODE(&arena->task_end_ev)))
+    {
+        return false;
+    }
+
+    EVENT_CALLBACK(&arena->task_end_ev) = _arena_private_on_task_end;
+    EVENT_PRIORITY(&arena->task_end_ev) = EVENT_PRIORITY(&task->event);
+
+    return task_end_wait(task, &arena->task_end_ev);
+}
+
+
+/*********************************************************
+ *@brief:
+ ***untie the arena from the task
+ *
+ *@parameter:
+ *[arena]: arena
+ *[task]: task bound by arena_task_bind
+ *
+ *@return value:
+ *[true]: unbound successfully
+ *[false]: the arena is not bound
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***解除arena与任务的绑定
+ *
+ *@参数：
+ *[arena]：arena
+ *[task]：由arena_task_bind绑定的任务
+ *
+ *@返回值：
+ *[true]：解除绑定成功
+ *[false]：arena未被绑定
+ **********************************************************/
+static inline bool arena_task_unbind(arena_t *arena, task_t *task)
+{
+    return task_end_wait_cancel(task, &arena->task_end_ev);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LIB_ARENA_H__ */
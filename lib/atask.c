@@ -5,4 +5,183 @@
 
 el_t dflt_el = EL_STATIC_INIT(dflt_el);
 
+#ifdef CONFIG_TASK_STACK_PROFILE
+task_stack_profile_t task_stack_profile;
+#endif
+
 void CONFIG_NULL_CB(void) {}
+
+#ifdef CONFIG_TASK_STACKFUL
+
+#define task_stackful_main EL_MACRO_CONCAT(task_stackful_main_m_, CONFIG_EL_MOUDLE_ID)
+#define task_ctx_entry EL_MACRO_CONCAT(task_ctx_entry_m_, CONFIG_EL_MOUDLE_ID)
+
+#define _TASK_CTX_STR(x)    _TASK_CTX_STR_(x)
+#define _TASK_CTX_STR_(x)   #x
+
+void task_stackful_main(task_t *task, task_stackful_routine_t func, void *arg);
+void task_ctx_entry(void);
+
+/* First frame of a stackful task, switches back to the event loop for good when the function returns */
+/* 有栈任务的第一个栈帧，函数返回时最终切换回事件循环 */
+void task_stackful_main(task_t *task, task_stackful_routine_t func, void *arg)
+{
+    void *end_sp;
+
+    func(task, arg);
+
+    task->sf_sp = NULL;
+    task_ctx_switch(&end_sp, task->sf_caller_sp);
+}
+
+#if defined(__x86_64__)
+
+/*
+ * The callee-saved registers of the System V ABI are pushed on the current stack,
+ * the stack pointers are swapped and the registers are popped from the other stack.
+ * The initial frame holds task, func and arg in r12, r13 and r14 for task_ctx_entry.
+ * Jumping to the saved address instead of ret keeps the return predictor of the CPU
+ * from mispredicting every switch.
+ */
+/*
+ * 将System V ABI的被调用者保存寄存器压入当前栈，交换栈指针后从另一个栈弹出。
+ * 初始栈帧在r12、r13与r14中保存task、func与arg，供task_ctx_entry使用。
+ * 使用跳转到保存的地址代替ret，避免CPU的返回预测在每次切换时失败
+ */
+__asm__(
+    ".text\n"
+    ".globl " _TASK_CTX_STR(task_ctx_switch) "\n"
+    ".type " _TASK_CTX_STR(task_ctx_switch) ", @function\n"
+    ".p2align 4\n"
+    _TASK_CTX_STR(task_ctx_switch) ":\n"
+    "    pushq %rbp\n"
+    "    pushq %rbx\n"
+    "    pushq %r12\n"
+    "    pushq %r13\n"
+    "    pushq %r14\n"
+    "    pushq %r15\n"
+    "    movq %rsp, (%rdi)\n"
+    "    movq %rsi, %rsp\n"
+    "    popq %r15\n"
+    "    popq %r14\n"
+    "    popq %r13\n"
+    "    popq %r12\n"
+    "    popq %rbx\n"
+    "    popq %rbp\n"
+    "    popq %rcx\n"
+    "    jmpq *%rcx\n"
+    ".size " _TASK_CTX_STR(task_ctx_switch) ", .-" _TASK_CTX_STR(task_ctx_switch) "\n"
+    ".globl " _TASK_CTX_STR(task_ctx_entry) "\n"
+    ".type " _TASK_CTX_STR(task_ctx_entry) ", @function\n"
+    ".p2align 4\n"
+    _TASK_CTX_STR(task_ctx_entry) ":\n"
+    "    movq %r12, %rdi\n"
+    "    movq %r13, %rsi\n"
+    "    movq %r14, %rdx\n"
+    "    call " _TASK_CTX_STR(task_stackful_main) "@PLT\n"
+    "    ud2\n"
+    ".size " _TASK_CTX_STR(task_ctx_entry) ", .-" _TASK_CTX_STR(task_ctx_entry) "\n"
+);
+
+void *task_ctx_make(task_t *task, task_stackful_routine_t func, void *arg)
+{
+    /* r15 r14 r13 r12 rbx rbp, return address, padding: task_ctx_entry starts with rsp aligned to 16 */
+    /* r15 r14 r13 r12 rbx rbp、返回地址、填充：task_ctx_entry开始时rsp按16对齐 */
+    uintptr_t *sp = (uintptr_t *)(((uintptr_t)task->stack.end & ~(uintptr_t)15) - 9 * sizeof(uintptr_t));
+
+    sp[0] = 0;
+    sp[1] = (uintptr_t)arg;
+    sp[2] = (uintptr_t)func;
+    sp[3] = (uintptr_t)task;
+    sp[4] = 0;
+    sp[5] = 0;
+    sp[6] = (uintptr_t)task_ctx_entry;
+    sp[7] = 0;
+    sp[8] = 0;
+
+    return sp;
+}
+
+#elif defined(__aarch64__)
+
+/*
+ * x19-x30 and d8-d15 of the AAPCS64 are saved in a 176 byte frame on the current stack,
+ * the stack pointers are swapped and the frame is restored from the other stack.
+ * The initial frame holds task, func and arg in x19, x20 and x21 and
+ * task_ctx_entry in x30.
+ */
+/*
+ * 将AAPCS64的x19-x30与d8-d15保存到当前栈上176字节的栈帧中，
+ * 交换栈指针后从另一个栈恢复。初始栈帧在x19、x20与x21中保存
+ * task、func与arg，在x30中保存task_ctx_entry
+ */
+__asm__(
+    ".text\n"
+    ".globl " _TASK_CTX_STR(task_ctx_switch) "\n"
+    ".type " _TASK_CTX_STR(task_ctx_switch) ", %function\n"
+    ".p2align 4\n"
+    _TASK_CTX_STR(task_ctx_switch) ":\n"
+    "    sub sp, sp, #176\n"
+    "    stp x19, x20, [sp, #0]\n"
+    "    stp x21, x22, [sp, #16]\n"
+    "    stp x23, x24, [sp, #32]\n"
+    "    stp x25, x26, [sp, #48]\n"
+    "    stp x27, x28, [sp, #64]\n"
+    "    stp x29, x30, [sp, #80]\n"
+    "    stp d8, d9, [sp, #96]\n"
+    "    stp d10, d11, [sp, #112]\n"
+    "    stp d12, d13, [sp, #128]\n"
+    "    stp d14, d15, [sp, #144]\n"
+    "    mov x2, sp\n"
+    "    str x2, [x0]\n"
+    "    mov sp, x1\n"
+    "    ldp x19, x20, [sp, #0]\n"
+    "    ldp x21, x22, [sp, #16]\n"
+    "    ldp x23, x24, [sp, #32]\n"
+    "    ldp x25, x26, [sp, #48]\n"
+    "    ldp x27, x28, [sp, #64]\n"
+    "    ldp x29, x30, [sp, #80]\n"
+    "    ldp d8, d9, [sp, #96]\n"
+    "    ldp d10, d11, [sp, #112]\n"
+    "    ldp d12, d13, [sp, #128]\n"
+    "    ldp d14, d15, [sp, #144]\n"
+    "    add sp, sp, #176\n"
+    "    ret\n"
+    ".size " _TASK_CTX_STR(task_ctx_switch) ", .-" _TASK_CTX_STR(task_ctx_switch) "\n"
+    ".globl " _TASK_CTX_STR(task_ctx_entry) "\n"
+    ".type " _TASK_CTX_STR(task_ctx_entry) ", %function\n"
+    ".p2align 4\n"
+    _TASK_CTX_STR(task_ctx_entry) ":\n"
+    "    mov x0, x19\n"
+    "    mov x1, x20\n"
+    "    mov x2, x21\n"
+    "    bl " _TASK_CTX_STR(task_stackful_main) "\n"
+    "    brk #0\n"
+    ".size " _TASK_CTX_STR(task_ctx_entry) ", .-" _TASK_CTX_STR(task_ctx_entry) "\n"
+);
+
+void *task_ctx_make(task_t *task, task_stackful_routine_t func, void *arg)
+{
+    /* x19-x28, x29 x30, d8-d15, padding */
+    /* x19-x28、x29 x30、d8-d15、填充 */
+    uintptr_t *sp = (uintptr_t *)(((uintptr_t)task->stack.end & ~(uintptr_t)15) - 176);
+    int i;
+
+    for (i = 0; i < 176 / (int)sizeof(uintptr_t); i++)
+    {
+        sp[i] = 0;
+    }
+
+    sp[0] = (uintptr_t)task;
+    sp[1] = (uintptr_t)func;
+    sp[2] = (uintptr_t)arg;
+    sp[11] = (uintptr_t)task_ctx_entry;
+
+    return sp;
+}
+
+#else
+#error "CONFIG_TASK_STACKFUL supports x86-64 and aarch64 only"
+#endif
+
+#endif /* CONFIG_TASK_STACKFUL */
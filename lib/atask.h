@@ -95,6 +95,103 @@ extern "C" {
 #define CONFIG_EL_MOUDLE_ID 
 
 
+/*********************************************************
+ *@description: 
+ ***Enable the growable slab mode (slab_init_growable).
+ ***A growable slab requests chunks from a page provider when
+ ***the free list is empty, and returns the chunks that stay
+ ***fully free for a period of time back to the provider.
+ *********************************************************
+ *@说明：
+ ***启用可增长的slab模式（slab_init_growable）。
+ ***可增长的slab在空闲链表为空时向页提供者申请内存块组（chunk），
+ ***并将持续完全空闲一段时间的chunk归还给页提供者
+ *********************************************************/
+/* #define CONFIG_SLAB_GROWABLE */
+
+
+/*********************************************************
+ *@description:
+ ***Enable the slab statistics (slab_stats_get): peak usage,
+ ***allocs, frees, failed allocations, waits and the histogram
+ ***of the time from slab_wait to the wake-up.
+ ***Without it the statistics compile to nothing.
+ *********************************************************
+ *@说明：
+ ***启用slab统计（slab_stats_get）：使用峰值、分配与释放次数、
+ ***分配失败次数、等待次数以及从slab_wait到被唤醒的等待时间直方图。
+ ***未定义时统计代码不参与编译
+ *********************************************************/
+/* #define CONFIG_SLAB_STATS */
+
+
+/*********************************************************
+ *@description:
+ ***Enable the task stack profiler: the peak stack usage of each task,
+ ***the peak per asynchronous function keyed by its address, and the
+ ***histogram of the peaks of the ended tasks for percentiles
+ ***(task_stack_profile_percentile), used to right-size the task stacks.
+ ***lib/atask.c must be compiled with the same setting.
+ *********************************************************
+ *@说明：
+ ***启用任务栈分析：每个任务的栈使用峰值、以异步函数地址为键的
+ ***各异步函数峰值，以及已结束任务峰值的直方图用于计算百分位
+ ***（task_stack_profile_percentile），用于确定合适的任务栈大小。
+ ***lib/atask.c须使用相同的配置编译
+ *********************************************************/
+/* #define CONFIG_TASK_STACK_PROFILE */
+
+
+/*********************************************************
+ *@description:
+ ***Enable segmented task stacks: a task whose stack would overflow
+ ***links a new stack segment allocated from the slab set by
+ ***task_stack_seg_slab_set, task_asyn_return unwinds across the
+ ***segments and frees them. Tasks can then start with a small stack
+ ***sized for the common case. Without a segment slab, or when the
+ ***slab is exhausted, the overflow still triggers TASK_ASSERT
+ *********************************************************
+ *@说明：
+ ***启用分段任务栈：栈将要溢出的任务从task_stack_seg_slab_set
+ ***设置的slab分配新的栈段并链接，task_asyn_return跨栈段回退并释放。
+ ***任务因此可以使用按常见情况确定的小栈启动。
+ ***没有栈段slab或slab耗尽时，溢出仍触发TASK_ASSERT
+ *********************************************************/
+/* #define CONFIG_TASK_SEGMENTED_STACK */
+
+
+/*********************************************************
+ *@description:
+ ***Enable task cancellation (task_cancel): asynchronous functions register
+ ***their pending timers, events and waits with the task, cancellation
+ ***withdraws all of them and resumes the task with the cancelled status
+ ***so that it unwinds through task_asyn_return
+ *********************************************************
+ *@说明：
+ ***启用任务取消（task_cancel）：异步函数向任务登记其挂起的定时器、
+ ***事件与等待，取消时撤销全部登记并以已取消状态恢复任务，
+ ***任务经由task_asyn_return逐层返回
+ *********************************************************/
+/* #define CONFIG_TASK_CANCEL */
+
+
+/*********************************************************
+ *@description:
+ ***Enable stackful tasks (task_stackful_start) on x86-64 and aarch64 Linux:
+ ***the task function runs on the task stack as a real C stack, locals
+ ***survive task_stackful_yield and plain C calls can be nested freely.
+ ***The context switch is written in assembly in lib/atask.c,
+ ***which must be compiled with the same setting
+ *********************************************************
+ *@说明：
+ ***在x86-64与aarch64 Linux上启用有栈任务（task_stackful_start）：
+ ***任务函数以任务栈作为真正的C栈运行，局部变量在task_stackful_yield
+ ***之后仍然有效，普通C调用可以任意嵌套。
+ ***上下文切换以汇编实现于lib/atask.c，其须使用相同的配置编译
+ *********************************************************/
+/* #define CONFIG_TASK_STACKFUL */
+
+
 /*********************************************************
  *@description:
  *** Concatenate two macros
@@ -1039,6 +1136,63 @@ static inline bool el_event_cancel(event_t *e)
 }
 
 
+/* Splice a queue of events of the same ready group into the ready group.
+ * the events are sorted by priority and already marked as ready,
+ * when the tail of the ready group is not lower than the head of
+ * the events, the whole queue is transferred at once */
+/* 将同一就绪组的事件队列拼接到就绪组中，
+ * 事件已按优先级排序且已标记为就绪，
+ * 当就绪组队尾优先级不低于事件队首优先级时，整个队列一次转移 */
+static inline void _el_private_events_splice(fifo_t *events, uint8_t ready_group)
+{
+#ifdef CONFIG_EL_HAVE_SCHEDULE_PREPARE
+    uint8_t el_old_have_event;
+#endif
+    fifo_t *ready_q = &dflt_el.ready_groups[ready_group];
+    slist_node_t *prev_node = SLIST_HEAD(FIFO_LIST(ready_q));
+    event_t *e;
+
+    if (fifo_is_empty(events))
+    {
+        return;
+    }
+
+    /* merge the events that are higher than the tail of the ready group */
+    /* 合并优先级高于就绪组队尾的事件 */
+    while (!fifo_is_empty(events) && !fifo_is_empty(ready_q)
+        && EVENT_PRIORITY(EVENT_OF_NODE(FIFO_TAIL(ready_q)))
+         < EVENT_PRIORITY(EVENT_OF_NODE(FIFO_TOP(events))))
+    {
+        e = event_fifo_priority_pop(events);
+
+        while (EVENT_PRIORITY(EVENT_OF_NODE(SLIST_NODE_NEXT(prev_node))) >= EVENT_PRIORITY(e))
+        {
+            prev_node = SLIST_NODE_NEXT(prev_node);
+        }
+
+        fifo_node_insert_next(ready_q, prev_node, EVENT_NODE(e));
+        prev_node = EVENT_NODE(e);
+    }
+
+    /* the rest are not higher than the tail, transfer them all */
+    /* 剩余事件均不高于队尾，全部转移 */
+    fifo_nodes_transfer_to(events, ready_q);
+
+#ifdef CONFIG_EL_HAVE_SCHEDULE_PREPARE
+    el_old_have_event = el_have_imm_event();
+#endif
+
+    dflt_el.ready_map |= (1 << ready_group);
+
+#ifdef CONFIG_EL_HAVE_SCHEDULE_PREPARE
+    if (!el_old_have_event)
+    {
+        _el_private_schedule_prepare_no_recursion();
+    }
+#endif
+}
+
+
 /*********************************************************
 *@brief:
 ***Reset the priority of posted events
@@ -1832,6 +1986,144 @@ static inline bool sem_give(sem_t *sem, event_t *event)
 }
 
 
+/* Wake up at most n events from the head of the waiting queue,
+ * the events of each ready group are spliced into the event loop at once */
+/* 从等待队列头部唤醒最多n个事件，每个就绪组的事件一次拼接到事件循环中 */
+static inline uint32_t _sem_private_waiters_wake(fifo_t *wait_q, uint32_t n)
+{
+    fifo_t wake_groups[READY_GROUP_COUNT];
+    event_t *e;
+    uint32_t woken = 0;
+    uint8_t i;
+
+    for (i = 0; i < READY_GROUP_COUNT; i++)
+    {
+        fifo_init(&wake_groups[i]);
+    }
+
+    while (woken < n && !fifo_is_empty(wait_q))
+    {
+        e = event_fifo_priority_pop(wait_q);
+        e->is_ready = 1;
+        fifo_push(&wake_groups[e->priority >> READY_GROUP_PRIORITY_SHIFT], EVENT_NODE(e));
+        woken++;
+    }
+
+    for (i = 0; i < READY_GROUP_COUNT; i++)
+    {
+        _el_private_events_splice(&wake_groups[i], i);
+    }
+
+    return woken;
+}
+
+
+/*********************************************************
+ *@brief: 
+ ***give up to n semaphores at once, same as calling sem_give(sem, NULL)
+ ***n times but stops at the first failure.
+ ***the events waiting in take_q are woken up first, in queue order
+ ***(higher priority first, first-in-first-out with the same priority),
+ ***and are posted to the event loop in the same order,
+ ***the rest increase the count until the limit is reached
+ *
+ *@contract: 
+ ***1. sem not is null pointer
+ *
+ *@parameter:
+ *[sem]: semaphore
+ *[n]: number of semaphores to give
+ *
+ *@return: the number of semaphores given, less than n when the limit is reached
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***一次释放最多n个信号量，等同于调用n次sem_give(sem, NULL)，
+ ***但在第一次失败时停止。
+ ***优先按队列顺序（高优先级优先，同优先级先进先出）唤醒take_q中的等待事件，
+ ***并按相同顺序提交到事件循环，剩余的部分增加计数值直到达到上限
+ * 
+ *@约定：
+ ***1、sem不能为空指针
+ *
+ *@参数：
+ *[sem]：信号量
+ *[n]：释放的信号量个数
+ *
+ *@返回：释放的信号量个数，达到上限时小于n
+ **********************************************************/
+static inline uint32_t sem_give_n(sem_t *sem, uint32_t n)
+{
+    uint32_t given = 0;
+    uint32_t room;
+
+    if (sem->cnt < sem->limit)
+    {
+        given = _sem_private_waiters_wake(&sem->take_q, n);
+
+        room = (uint32_t)(sem->limit - sem->cnt);
+        room = (n - given) < room ? (n - given) : room;
+        sem->cnt += (int32_t)room;
+        given += room;
+    }
+
+    return given;
+}
+
+
+/*********************************************************
+ *@brief: 
+ ***take up to n semaphores at once, same as calling sem_take(sem, NULL)
+ ***n times but stops at the first failure.
+ ***the events waiting in give_q are woken up first, in queue order
+ ***(higher priority first, first-in-first-out with the same priority),
+ ***and are posted to the event loop in the same order,
+ ***the rest decrease the count until it reaches 0
+ *
+ *@contract: 
+ ***1. sem not is null pointer
+ *
+ *@parameter:
+ *[sem]: semaphore
+ *[n]: number of semaphores to take
+ *
+ *@return: the number of semaphores taken, less than n when the count runs out
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***一次获取最多n个信号量，等同于调用n次sem_take(sem, NULL)，
+ ***但在第一次失败时停止。
+ ***优先按队列顺序（高优先级优先，同优先级先进先出）唤醒give_q中的等待事件，
+ ***并按相同顺序提交到事件循环，剩余的部分减少计数值直到为0
+ * 
+ *@约定：
+ ***1、sem不能为空指针
+ *
+ *@参数：
+ *[sem]：信号量
+ *[n]：获取的信号量个数
+ *
+ *@返回：获取的信号量个数，计数值不足时小于n
+ **********************************************************/
+static inline uint32_t sem_take_n(sem_t *sem, uint32_t n)
+{
+    uint32_t taken = 0;
+    uint32_t avail;
+
+    if (sem->cnt > 0)
+    {
+        taken = _sem_private_waiters_wake(&sem->give_q, n);
+
+        avail = (uint32_t)sem->cnt;
+        avail = (n - taken) < avail ? (n - taken) : avail;
+        sem->cnt -= (int32_t)avail;
+        taken += avail;
+    }
+
+    return taken;
+}
+
+
 /*********************************************************
  *@brief: 
  ***Cancel the event of sem_give
@@ -1928,923 +2220,6301 @@ static inline bool sem_take_cancel(sem_t *sem, event_t *event)
 }
 
 
-/* slab allocator definition */
-/* slab分配器定义 */
-typedef struct slab_s
+/*********************************************************
+ *@type description:
+ *
+ *[sem_timed_event_t]: semaphore take event with timeout,
+ ***the internal timer removes the event from the take_q
+ ***of the semaphore when it expires
+ *********************************************************
+ *@类型说明：
+ *
+ *[sem_timed_event_t]：带超时的取信号量事件，
+ ***内部定时器到期时将事件从信号量的take_q中移除
+ *********************************************************/
+typedef struct sem_timed_event_s
 {
-    /* block size */
-    /* 块大小 */
-    uint32_t    blk_size;
+    /* take event, queued in the take_q of the semaphore */
+    /* 取信号量事件，在信号量的take_q中排队 */
+    event_t event;
 
-    /* number of block */
-    /* 块数 */
-    uint32_t    blk_nums;
+    /* timeout timer */
+    /* 超时定时器 */
+    timer_event_t timer;
 
-    /* number of used block */
-    /* 已使用的块数 */
-    uint32_t    nums_used;
+    /* the semaphore being waited on */
+    /* 正在等待的信号量 */
+    sem_t *sem;
 
-    /* record the original buff pointer */
-    /* 记录原始的buff指针 */
-    uint8_t     *buff;
+    /* callback and context of the waiter */
+    /* 等待者的回调与上下文 */
+    event_cb notify_cb;
+    void *notify_ctx;
 
-    /* slab available notification queue */
-    /* slab可用通知队列 */
-    fifo_t    notify_q;
+    /* the wait is timeout */
+    /* 等待已超时 */
+    uint8_t is_timeout;
+} sem_timed_event_t;
 
-    /* free block list */
-    /* 空闲块链表 */
-    slist_t free_list;
-} slab_t;
 
+/* Take event arrives, stop the timer and notify the waiter */
+/* 取信号量事件到达，停止定时器并通知等待者 */
+static inline void _sem_private_timed_event_on_take(void *ctx, event_t *e)
+{
+    sem_timed_event_t *te = (sem_timed_event_t *)ctx;
 
-/* slab allocate event */
-/* slab分配事件 */
-typedef struct slab_alloc_event_s
+    el_timer_stop(&te->timer);
+    te->notify_cb(te->notify_ctx, e);
+}
+
+/* Timer expires, remove the take event from the take_q and notify the waiter */
+/* 定时器到期，将取信号量事件从take_q中移除并通知等待者 */
+static inline void _sem_private_timed_event_on_timeout(void *ctx, event_t *e)
 {
-    event_t event;
-    void *mem_blk;
-} slab_alloc_event_t;
+    sem_timed_event_t *te = (sem_timed_event_t *)ctx;
+
+    (void)e;
+
+    /* The semaphore has been taken, the take event will arrive soon */
+    /* 信号量已取得，取信号量事件即将到达 */
+    if (el_event_is_ready(&te->event)
+     || !fifo_del_node(&te->sem->take_q, EVENT_NODE(&te->event)))
+    {
+        return;
+    }
+
+    te->is_timeout = 1;
+    te->notify_cb(te->notify_ctx, &te->event);
+}
 
 
 /************************************************************
  *@brief:
- ***slab event structure static initialization
- *
- *@Usage:
- ***slab_alloc_event_t slab_event
- ***     = SLAB_ALLOC_EVENT_STATIC_INIT(slab_event, callback, ctx);
+ ***Semaphore timed event initialization
  *
  *@parameter:
- *[slab_event]: slab event variable name, non-address
- *[callback]: event callback function (valid when called with 2 arguments)
- *[ctx]: callback context of the event (valid when called with 3 arguments)
- *[priority]: priority of the event (valid when called with 4 arguments)
- *[id]: ID of the event (valid when called with 5 arguments)
- *[state]: state of the event (valid when called with 6 arguments)
+ *[te]: the semaphore timed event
+ *[callback]: callback of the waiter
+ *[ctx]: callback context of the waiter
+ *[priority]: priority of the event
  *************************************************************/
 /************************************************************
  *@简介：
- ***分配器事件结构体静态初始化
- *
- *@用法：
- ***slab_alloc_event_t slab_event
- ***     = SLAB_ALLOC_EVENT_STATIC_INIT(slab_event, callback, ctx);
+ ***带超时的信号量事件初始化
  *
  *@参数：
- *[slab_event]：分配器事件变量名，非地址
- *[callback]：事件回调函数
- *[ctx]：事件的回调上下文
+ *[te]：带超时的信号量事件
+ *[callback]：等待者的回调函数
+ *[ctx]：等待者的回调上下文
  *[priority]：事件的优先级
  *************************************************************/
-#define SLAB_ALLOC_EVENT_STATIC_INIT(slab_event, ecb, ctx, priority)    \
-{                                                                       \
-    EVENT_STATIC_INIT((slab_event).event, (ecb), (ctx), (priority)),    \
-    NULL                                                                \
+static inline void sem_timed_event_init(sem_timed_event_t *te,
+                                        event_cb callback,
+                                        void *ctx,
+                                        uint8_t priority)
+{
+    event_init(&te->event, _sem_private_timed_event_on_take, te, priority);
+    timer_init(&te->timer, _sem_private_timed_event_on_timeout, te, priority);
+    te->sem = NULL;
+    te->notify_cb = callback ? callback : EVENT_NULL_CB;
+    te->notify_ctx = ctx;
+    te->is_timeout = 0;
 }
 
-#define slab_alloc_event_init(slab_event, ecb, ctx, priority)       \
-    do                                                              \
-    {                                                               \
-        event_init(&(slab_event)->event, (ecb), (ctx), (priority)); \
-        (slab_event)->mem_blk = NULL;                               \
-    } while (0)
-
-#define slab_alloc_event_init_inherit(slab_event, parent)           \
-    do                                                              \
-    {                                                               \
-        event_init_inherit(&(slab_event)->event, (parent));         \
-        (slab_event)->mem_blk = NULL;                               \
-    } while (0)
-
-
-#define SLAB_ALLOC_EVENT_EVENT(slab_event)  (&(slab_event)->event)
-
-#define SLAB_ALLOC_EVENT_NODE(slab_event)   EVENT_NODE(&(slab_event)->event)
 
-#define SLAB_ALLOC_EVENT_OF_EVENT(_event) container_of(_event, slab_alloc_event_t, event)
+/************************************************************
+ *@brief:
+ ***Semaphore timed event inheritance initialization,
+ ***will inherit the parent event callback function,
+ ***context, priority
+ *
+ *@parameter:
+ *[te]: the semaphore timed event
+ *[parent]: parent event
+ *************************************************************/
+/************************************************************
+ *@简介：
+ ***带超时的信号量事件继承初始化，将继承父事件的回调函数，上下文，优先级
+ *
+ *@参数：
+ *[te]：带超时的信号量事件
+ *[parent]：父事件
+ *************************************************************/
+static inline void sem_timed_event_init_inherit(sem_timed_event_t *te, const event_t *parent)
+{
+    sem_timed_event_init(te, parent->callback, parent->context, parent->priority);
+}
 
-#define SLAB_ALLOC_EVENT_OF_NODE(node) container_of(EVENT_OF_NODE(node), slab_alloc_event_t, event)
 
-/*********************************************
- *@brief：get the original buffer pointer of slab
+/*********************************************************
+ *@brief: 
+ ***Check whether the wait of sem_take_timeout is timeout
  *
  *@parameter:
- *[slab]: slab allocator
+ *[te]: the event used in sem_take_timeout
  *
- *@return: the original buff of slab
- *********************************************
- */
-/*********************************************
- *@简要：获取slab原始的buffer指针
+ *@return value:
+ *[true]: timeout, the semaphore was not taken
+ *[false]: the semaphore was taken
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***判断sem_take_timeout的等待是否超时
  *
- *@参数
- *[slab] slab分配器
+ *@参数：
+ *[te]：sem_take_timeout中使用的事件
  *
- *@返回：slab的原始的buff
- *********************************************
- */
-static inline void *slab_buff_get(slab_t *slab)
+ *@返回值：
+ *[true]：已超时，未取得信号量
+ *[false]：已取得信号量
+ **********************************************************/
+static inline bool sem_timed_event_is_timeout(sem_timed_event_t *te)
 {
-    return slab->buff;
+    return te->is_timeout != 0;
 }
 
 
-/*********************************************
- *@brief：get the total number of slab
+/*********************************************************
+ *@brief: 
+ ***take semaphore with timeout, semaphore count minus 1.
+ ***The waiter is notified with &te->event when the semaphore is taken
+ ***or the wait is timeout, use sem_timed_event_is_timeout to
+ ***distinguish them.
  *
- *@parameter: 
- *[slab] slab allocator
+ *@contract: 
+ ***1. sem and te not are null pointers
+ ***2. te was initialized by sem_timed_event_init(_inherit)
  *
- *@return: the total number of slab
- *********************************************
- */
-/*********************************************
- *@简要：获取slab的总块数
+ *@parameter:
+ *[sem]: semaphore
+ *[te]: the semaphore timed event
+ *[timeout]: millisecond timeout
+ *
+ *@return value:
+ *[true]: the event is posted or queued
+ *[false]: the event or the timer is referenced
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***带超时地取信号量，信号量计数值减1。
+ ***取得信号量或等待超时时都将以&te->event通知等待者，
+ ***使用sem_timed_event_is_timeout进行区分
+ * 
+ *@约定：
+ ***1、sem与te不能为空指针
+ ***2、te已由sem_timed_event_init(_inherit)初始化
  *
  *@参数：
- *[slab] slab分配器
+ *[sem]：信号量
+ *[te]：带超时的信号量事件
+ *[timeout]：毫秒超时时间
  *
- *@返回：slab总块数
- *********************************************
- */
-static inline uint32_t slab_blk_nums_get(slab_t *slab)
+ *@返回值：
+ *[true]：事件已提交或已排队
+ *[false]：事件或定时器处于引用状态
+ **********************************************************/
+static inline bool sem_take_timeout(sem_t *sem, sem_timed_event_t *te, time_ms_t timeout)
 {
-    return slab->blk_nums;
+    if (!slist_node_is_del(TIMER_NODE(&te->timer))
+     || !sem_take(sem, &te->event))
+    {
+        return false;
+    }
+
+    te->sem = sem;
+    te->is_timeout = 0;
+
+    /* the semaphore is not available, start the timeout timer */
+    /* 信号量不可用，开启超时定时器 */
+    if (!el_event_is_ready(&te->event))
+    {
+        el_timer_start_ms(&te->timer, timeout);
+    }
+
+    return true;
 }
 
 
-/*********************************************
- *@brief: get the number of blocks used by slab
+/*********************************************************
+ *@brief: 
+ ***Cancel the event of sem_take_timeout
+ *
+ *@contract: 
+ ***Cannot use null pointer
  *
  *@parameter:
- *[slab] slab allocator
+ *[te]: the event used in sem_take_timeout
  *
- *@return: the number of blocks used by slab
- *********************************************
- */
-/*********************************************
- *@简要：获取slab已使用的块数
+ *@return value:
+ *[true]: cancel success
+ *[false]: cancel failed
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***取消sem_take_timeout的事件
+ *
+ *@约定：
+ ***不能使用空指针
  *
  *@参数：
- *[slab] slab分配器
+ *[te]: sem_take_timeout中使用的事件
  *
- *@返回：slab已使用的块数
- *********************************************
- */
-static inline uint32_t slab_used_get(slab_t *slab)
+ *@返回值：
+ *[true]：取消成功
+ *[false]：取消失败
+ **********************************************************/
+static inline bool sem_take_timeout_cancel(sem_timed_event_t *te)
 {
-    return slab->nums_used;
+    el_timer_stop(&te->timer);
+
+    return te->sem != NULL && sem_take_cancel(te->sem, &te->event);
 }
 
 
-/*********************************************
- *@brief: get the number of blocks unused by slab
+/*********************************************************
+ *@type description:
  *
- *@parameter:
- *[slab] slab allocator
+ *[acond_t]: asynchronous condition variable,
+ ***the waiting events are queued by priority group,
+ ***so that broadcast can splice each group into the event loop
+ *********************************************************
+ *@类型说明：
  *
- *@return: the number of blocks unused by slab
- *********************************************
- */
-/*********************************************
- *@简要：获取slab未使用的块数
+ *[acond_t]：异步条件变量，等待事件按优先级组排队，
+ ***广播时可将每一组整体拼接到事件循环中
+ *********************************************************/
+typedef struct acond_s
+{
+    /* waiting event queue of each priority group */
+    /* 每个优先级组的等待事件队列 */
+    fifo_t wait_groups[READY_GROUP_COUNT];
+} acond_t;
+
+
+/************************************************************
+ *@brief:
+ ***condition variable static initialization
  *
- *@参数：
- *[slab] slab分配器
+ *@parameter:
+ *[c]: condition variable variable name, non-address
+ *************************************************************/
+/************************************************************
+ *@简介：
+ ***条件变量静态初始化
  *
- *@返回：slab未使用的块数
- *********************************************
- */
-static inline uint32_t slab_unused_get(slab_t *slab)
-{
-    return slab->blk_nums - slab->nums_used;
+ *@参数：
+ *[c]：条件变量变量名，非地址
+ *************************************************************/
+#define ACOND_STATIC_INIT(c)                            \
+{                                                       \
+    {                                                   \
+        FIFO_STATIC_INIT((c).wait_groups[0]),           \
+        FIFO_STATIC_INIT((c).wait_groups[1]),           \
+        FIFO_STATIC_INIT((c).wait_groups[2]),           \
+        FIFO_STATIC_INIT((c).wait_groups[3])            \
+    }                                                   \
 }
 
-/*********************************************
- *@brief: get the size of the slab block
+
+/*********************************************************
+ *@brief: 
+ ***condition variable initialization
+ *
+ *@contract: 
+ ***1. c is not null pointer
+ ***2. cannot initialize the condition variable being waited
  *
  *@parameter:
- *[slab] slab allocator
+ *[c]: condition variable
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***条件变量初始化
  *
- *@return: the size of the slab block
- *********************************************
- */
-/*********************************************
- *@简要：获取slab块的大小
+ *@约定：
+ ***1、c不是空指针
+ ***2、不可对正在被等待的条件变量进行初始化
  *
  *@参数：
- *[slab] slab分配器
- *
- *@返回：slab块的大小
- *********************************************
- */
-static inline uint32_t slab_blk_size_get(slab_t *slab)
+ *[c]：条件变量
+ **********************************************************/
+static inline void acond_init(acond_t *c)
 {
-    return slab->blk_size;
+    uint8_t i;
+
+    for (i = 0; i < READY_GROUP_COUNT; i++)
+    {
+        fifo_init(&c->wait_groups[i]);
+    }
 }
 
 
-/*********************************************
- *@brief: initialize a slab allocator using buffer initialization
+/*********************************************************
+ *@brief: 
+ ***check whether there are events waiting on the condition variable
  *
  *@parameter:
- *[slab] slab allocator
- *[buff] buffer
- *[blk_nums] total number of blocks
- *[blk_size] the size of each block
- *********************************************
- */
-/*********************************************
- *@简要：使用buffer初始化一个slab分配器
+ *[c]: condition variable
+ *
+ *@return value:
+ *[true]: there are waiting events
+ *[false]: no waiting events
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***检查是否有事件在等待条件变量
  *
  *@参数：
- *[slab]	 slab
- *[buff]     buffer
- *[blk_nums] buffer大小
- *[blk_size] 每块的大小
- *********************************************
- */
-static inline void slab_init(slab_t *slab, void *buff, uint32_t buf_size, uint32_t blk_size)
+ *[c]：条件变量
+ *
+ *@返回值：
+ *[true]：存在等待事件
+ *[false]：没有等待事件
+ **********************************************************/
+static inline bool acond_have_waiters(acond_t *c)
 {
-    uint8_t *align_buff;
-    uint32_t size;
-    uint8_t *free_node;
-    uint32_t i;
-
-    /* pointer alignment */
-    /* 指针向上取整对齐 */
-    align_buff = (uint8_t *)ALIGN_UP((size_t)buff);
-
-    /* size alignment */
-    /* 计算对齐后，可用size */
-    size = ALIGN_DOWN((uint8_t *)buff + buf_size - align_buff);
-
-	/* blk_size cpu-byte alignment */
-	/* blk_size CPU字节对齐 */
-	slab->blk_size = (uint32_t)ALIGN_UP(blk_size);
+    uint8_t i;
 
-	/* calculate the number of total blocks */
-	/* 重新计算总的块数 */
-	slab->blk_nums = size / slab->blk_size;
+    for (i = 0; i < READY_GROUP_COUNT; i++)
+    {
+        if (!fifo_is_empty(&c->wait_groups[i]))
+        {
+            return true;
+        }
+    }
 
-	slab->nums_used = 0;
+    return false;
+}
 
-	/* record buff */
-	/* 记录buff */
-	slab->buff = align_buff;
 
-	fifo_init(&slab->notify_q);
+/*********************************************************
+ *@brief: 
+ ***wait for the condition variable,
+ ***the event is triggered by acond_signal or acond_broadcast.
+ ***the waiting event is not ready (el_event_is_ready returns false)
+ ***until it is woken up and moved into the event loop
+ *
+ *@contract: 
+ ***Cannot use null pointer
+ *
+ *@parameter:
+ *[c]: condition variable
+ *[ev]: the event of notification
+ *
+ *@return value:
+ *[true]: start waiting
+ *[false]: the event is in the queue or reference state
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***等待条件变量，事件由acond_signal或acond_broadcast触发。
+ ***等待中的事件未就绪（el_event_is_ready返回false），
+ ***直到被唤醒并移入事件循环
+ *
+ *@约定：
+ ***不能使用空指针
+ *
+ *@参数：
+ *[c]：条件变量
+ *[ev]：通知事件
+ *
+ *@返回值：
+ *[true]：开始等待
+ *[false]：事件节点处于队列之中或者引用状态
+ **********************************************************/
+static inline bool acond_wait(acond_t *c, event_t *ev)
+{
+    if (!slist_node_is_del(EVENT_NODE(ev)))
+    {
+        return false;
+    }
 
-	/* initialize the free list */
-	/* 初始化空闲块链表 */
-	slist_init((slist_t *)&slab->free_list);
+    event_fifo_priority_push(&c->wait_groups[ev->priority >> READY_GROUP_PRIORITY_SHIFT], ev);
 
-	/* generates a free block list */
-	/* 生成空闲块链表 */
-	free_node = align_buff;
-	for (i = 0; i < slab->blk_nums; i++)
-	{
-		slist_node_insert_next(SLIST_HEAD(&slab->free_list), (slist_node_t *)free_node);
-		free_node += slab->blk_size;
-	}
+    return true;
 }
 
-/*********************************************
- *@brief: initialize a slab allocator using array initialization
+
+/*********************************************************
+ *@brief: 
+ ***wake up the highest priority event waiting on the condition variable
+ *
+ *@contract: 
+ ***Cannot use null pointer
  *
  *@parameter:
- *[slab] slab allocator
- *[arr] array
- *********************************************
- */
-/*********************************************
- *@简要：使用数组初始化一个slab分配器
- *
- *@参数：
- *[slab]	slab
- *[arr]     数组
- *********************************************
- */
-#define slab_init_by_arr(slab, arr)		slab_init((slab), (arr), sizeof(arr), sizeof((arr)[0]))
-
-/*********************************************
- *@brief: the slab allocator allocate memory block
+ *[c]: condition variable
  *
- *@param:
- *[slab] slab allocator
+ *@return value:
+ *[true]: an event was woken up
+ *[false]: no waiting events
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***唤醒等待条件变量的最高优先级事件
  *
- *@return: memory block
- *********************************************
- */
-/*********************************************
- *@简要：slab分配器分配内存块
+ *@约定：
+ ***不能使用空指针
  *
  *@参数：
- *[slab] slab分配器
+ *[c]：条件变量
  *
- *@返回： 内存块
- *********************************************
- */
-static inline void *slab_alloc(slab_t *slab)
+ *@返回值：
+ *[true]：唤醒了一个事件
+ *[false]：没有等待事件
+ **********************************************************/
+static inline bool acond_signal(acond_t *c)
 {
-    /* cannot allocate memory when the queue is empty */
-    /* 当队列为空时，不能进行内存分配 */
-    if (slist_is_empty(&slab->free_list))
+    uint8_t i = READY_GROUP_COUNT;
+
+    while (i--)
     {
-        return NULL;
-    }
+        if (!fifo_is_empty(&c->wait_groups[i]))
+        {
+            el_event_post(event_fifo_priority_pop(&c->wait_groups[i]));
 
-    slab->nums_used++;
+            return true;
+        }
+    }
 
-    /* take a free node */
-    /* 取出一个空闲节点，并返回 */
-    return (void *)slist_node_del_next(&slab->free_list);
+    return false;
 }
 
 
-/*********************************************
- *@brief: the slab allocator free memory block
+/*********************************************************
+ *@brief: 
+ ***wake up all events waiting on the condition variable,
+ ***the waiting events are marked as ready
+ ***and each priority group is spliced into the event loop as a whole
+ *
+ *@contract: 
+ ***Cannot use null pointer
  *
  *@parameter:
- *[slab] slab allocator
- *[mem] slab block
+ *[c]: condition variable
  *
- *@return: N/A
- *********************************************
- */
-/*********************************************
- *@简要：slab分配器释放内存块
+ *@return value:
+ *[true]: events were woken up
+ *[false]: no waiting events
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***唤醒所有等待条件变量的事件，等待事件被标记为就绪，
+ ***每个优先级组整体拼接到事件循环中
+ *
+ *@约定：
+ ***不能使用空指针
  *
  *@参数：
- *[slab] slab分配器
- *[mem] 内存块
+ *[c]：条件变量
  *
- *@返回：无
- *********************************************
- */
-static inline void slab_free(slab_t *slab, void *mem)
+ *@返回值：
+ *[true]：唤醒了事件
+ *[false]：没有等待事件
+ **********************************************************/
+static inline bool acond_broadcast(acond_t *c)
 {
-    slab_alloc_event_t *alloc_event;
+    slist_node_t *node;
+    bool have_waiters = false;
+    uint8_t i;
 
-    /* notification waiter slab is available */
-    /* 通知等待者slab已可用 */
-    if (!fifo_is_empty(&slab->notify_q))
-    {
-        alloc_event = SLAB_ALLOC_EVENT_OF_EVENT(event_fifo_priority_pop(&slab->notify_q));
-        alloc_event->mem_blk = mem;
-        el_event_post(&alloc_event->event);
-    }
-    else
+    for (i = 0; i < READY_GROUP_COUNT; i++)
     {
-        /* insert the node into the queue */
-        /* 将节点插入队列 */
-        slist_node_insert_next(SLIST_HEAD(&slab->free_list), (slist_node_t *)mem);
-
-        slab->nums_used--;
-    }
-}
-
+        if (!fifo_is_empty(&c->wait_groups[i]))
+        {
+            slist_foreach(FIFO_LIST(&c->wait_groups[i]), node)
+            {
+                EVENT_OF_NODE(node)->is_ready = 1;
+            }
 
-/*********************************************
- *@brief: wait for the slab allocator to have a memory block available
- *
- *@param:
- *[slab] slab allocator
- *
- *@return:
- *[true] the slab allocator adds events successfully
- *[false] events are in other queues and cannot be enqueue
- *********************************************
- */
-/*********************************************
- *@简要：等待slab分配器有内存块可用
- *
- *@参数：
- *[slab] slab分配器
- *
- *@返回：
- *[true] slab分配器添加事件成功
- *[false] 事件以处于其他队列中，不能入队
- *********************************************
- */
-static inline bool slab_wait(slab_t *slab, slab_alloc_event_t *alloc_event)
-{
-    /* 将事件添加到等待列表 */
-    if (slist_node_is_del(SLAB_ALLOC_EVENT_NODE(alloc_event)))
-    {
-        event_fifo_priority_push(&slab->notify_q, SLAB_ALLOC_EVENT_EVENT(alloc_event));
+            _el_private_events_splice(&c->wait_groups[i], i);
 
-        /* 若有内存可用，则唤醒等待队列中的一个事件 */
-        if (!slist_is_empty(&slab->free_list))
-        {
-            alloc_event = SLAB_ALLOC_EVENT_OF_EVENT(event_fifo_priority_pop(&slab->notify_q));
-            alloc_event->mem_blk = slist_node_del_next(SLIST_HEAD(&slab->free_list));
-            el_event_post(&alloc_event->event);
+            have_waiters = true;
         }
-
-        return true;
     }
 
-    return false;
+    return have_waiters;
 }
 
 
-/*********************************************
- *@brief: Cancel the event waiting for the slab allocator
+/*********************************************************
+ *@brief:
+ ***cancel the event of acond_wait, whether it is still waiting
+ ***or has been woken up but not yet triggered
  *
- *@contract: slab_wait_cancel can only cancel events waiting by slab_wait
- * 
- *@param:
- *[slab] slab allocator
- *[alloc_event] allocator event
+ *@contract:
+ ***Cannot use null pointer
  *
- *@return:
- *[true] Cancel the slab allocator event successfully
- *[false] Slab allocator event is not in the wait queue
- *********************************************
- */
-/*********************************************
- *@简要：取消等待slab分配器的事件
+ *@parameter:
+ *[c]: condition variable
+ *[ev]: the event used in acond_wait
+ *
+ *@return value:
+ *[true]: cancel success
+ *[false]: cancel failed
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***取消acond_wait的事件，无论其仍在等待，还是已被唤醒但尚未触发
+ *
+ *@约定：
+ ***不能使用空指针
  *
- *@约定：slab_wait_cancel只能取消由slab_wait等待的事件
- * 
  *@参数：
- *[slab] slab分配器
- *[alloc_event] 分配器事件
+ *[c]：条件变量
+ *[ev]: acond_wait中使用的事件
  *
- *@返回：
- *[true] 取消slab分配器事件成功
- *[false] slab分配器事件不处于等待队列中
- *********************************************
- */
-static inline bool slab_wait_cancel(slab_t *slab, slab_alloc_event_t *alloc_event)
+ *@返回值：
+ *[true]：取消成功
+ *[false]：取消失败
+ **********************************************************/
+static inline bool acond_wait_cancel(acond_t *c, event_t *ev)
 {
-    if (el_event_is_ready(&alloc_event->event))
+    if (slist_node_is_del(EVENT_NODE(ev)))
     {
-        slab_free(slab, alloc_event->mem_blk);
-        alloc_event->mem_blk = NULL;
-
-        return el_event_cancel(&alloc_event->event);
+        return false;
     }
 
-    return fifo_del_node(&slab->notify_q, EVENT_NODE(&alloc_event->event));
+    if (el_event_is_ready(ev))
+    {
+        return el_event_cancel(ev);
+    }
+    else
+    {
+        return fifo_del_node(&c->wait_groups[ev->priority >> READY_GROUP_PRIORITY_SHIFT], EVENT_NODE(ev));
+    }
 }
 
-#ifndef TASK_ASSERT
-#define TASK_ASSERT(expr)
-#endif /* TASK_ASSERT */
-
-#ifndef TASK_INFO
-#define TASK_INFO(task, stack_size, stack_used)
-#endif /* TASK_INFO */
 
 /*********************************************************
  *@type description:
  *
- *[struct task_cur_ctx_s]：task current context information
- *[struct task_stack_s]：task current stack pointer information
- *[task_t]：task data structure
+ *[future_t]: asynchronous result, completed once with a value
+ ***or an error code, and can be awaited by multiple events.
+ ***it needs no heap and can be placed in task_asyn_vars_get
  *********************************************************
  *@类型说明：
  *
- *[struct task_cur_ctx_s]：task当前的上下文信息
- *[struct task_stack_s]：task当前栈指针信息
- *[task_t]：task数据结构
+ *[future_t]：异步结果，以一个值或错误码完成一次，可被多个事件等待。
+ ***无需堆内存，可放在task_asyn_vars_get分配的变量中
  *********************************************************/
-struct task_cur_ctx_s
+typedef struct future_s
 {
-    uint8_t yield_state;
-    uint8_t bp;
-    uint16_t stack_used;
-};
-
-struct task_stack_s
-{
-    uint8_t *start;
-    uint8_t *end;
-    uint8_t *cur;
-};
+    /* events waiting for completion */
+    /* 等待完成的事件 */
+    acond_t waiters;
 
-typedef struct task_s
-{
-    event_t event;
-    struct task_stack_s stack;
-    struct task_cur_ctx_s cur_ctx;
-    union 
+    /* result value */
+    /* 结果值 */
+    union
     {
         void *ptr;
+        uint64_t u64;
+        int64_t s64;
         uint32_t u32;
-        int32_t  s32;
-    } ret_val;
-    lifo_t task_end_notify_q;
-} task_t;
-
-
-/*********************************************************
- *@type description:
- *
- *[task_asyn_routine_t]: task function and asynchronous function type
- *********************************************************
- *@类型说明：
- *
- *[task_asyn_routine_t]：任务函数与异步函数类型
- *********************************************************/
-typedef void (*task_asyn_routine_t)(struct task_s *, event_t *);
+        int32_t s32;
+    } value;
 
+    /* error code, 0 is success */
+    /* 错误码，0为成功 */
+    int32_t error;
 
-/* TASK bpd pointer, Used by bpd coroutine */
-/* TASK的bpd指针，由bpd协程使用 */
-#define TASK_BPD(task)  (&((task_t *)(task))->cur_ctx.bp)
+    /* completed flag */
+    /* 已完成标志 */
+    uint8_t is_done;
+} future_t;
 
 
 /************************************************************
  *@brief:
- ***Task data structure static initialization
+ ***future static initialization
  *
  *@parameter:
- *[task]: Task variable name, non-pointer
- *[task_func]: Task function
- *[stack]：Task stack
- *[stack_size]：Stack size
- *[priority]：Priority of task events
+ *[f]: future variable name, non-address
  *************************************************************/
 /************************************************************
  *@简介：
- ***任务数据结构静态初始化
+ ***future静态初始化
  *
  *@参数：
- *[task]：任务的变量名，非指针
- *[task_func]：任务函数
- *[stack]：任务的栈
- *[stack_size]：栈的大小
- *[priority]：任务事件的优先级
+ *[f]：future变量名，非地址
  *************************************************************/
-#define TASK_STATIC_INIT(task, stack, stack_size, priority)                     \
-{                                                                               \
-    EVENT_STATIC_INIT((task).event, (event_cb)NULL_CB, &task, (priority)),      \
-    {                                                                           \
-        (stack),                                                                \
-        (uint8_t *)(stack) + (stack_size),                                      \
-        (stack),                                                                \
-    },                                                                          \
-    {0, 0, BP_INIT_VAL},                                                        \
-    {0},                                                                        \
-    LIFO_STATIC_INIT((task).task_end_notify_q)                                  \
+#define FUTURE_STATIC_INIT(f)               \
+{                                           \
+    ACOND_STATIC_INIT((f).waiters),         \
+    {0},                                    \
+    0,                                      \
+    0                                       \
 }
 
 
-/************************************************************
- *@brief:
- ***Define a task object, and initialize
+/*********************************************************
+ *@brief: 
+ ***future initialization
+ *
+ *@contract: 
+ ***1. f is not null pointer
+ ***2. cannot initialize the future being awaited
  *
  *@parameter:
- *[_name]：The name of the task object
- *[task_func]：Task function
- *[stack_size]：Stack size
- *[priority]：Priority of task events
- *************************************************************/
-/************************************************************
- *@简介：
- ***定义一个任务对象，并初始化
+ *[f]: future
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***future初始化
+ *
+ *@约定：
+ ***1、f不是空指针
+ ***2、不可对正在被等待的future进行初始化
  *
  *@参数：
- *[_name]：任务对象的名字
- *[task_func]：任务函数
- *[stack_size]：任务栈的大小
- *[priority]：任务事件的优先级
- *************************************************************/
-#define TASK_DEFINE(_name, stack_size, priority)                    \
-    uint32_t _name##_stack_buf[(stack_size + 3) / 4];               \
-    task_t  _name = TASK_STATIC_INIT(_name,                         \
-                                     _name##_stack_buf,             \
-                                     (stack_size),                  \
-                                     (priority))
+ *[f]：future
+ **********************************************************/
+static inline void future_init(future_t *f)
+{
+    acond_init(&f->waiters);
+    f->value.u64 = 0;
+    f->error = 0;
+    f->is_done = 0;
+}
 
 
-/************************************************************
- *@brief:
- ***Define a task object using static modifiers, and initialize
+/*********************************************************
+ *@brief: 
+ ***reset a completed future so that it can be used again
  *
  *@parameter:
- *[_name]：The name of the task object
- *[task_func]：Task function
- *[stack_size]：Stack size
- *[priority]：Priority of task events
- *************************************************************/
-/************************************************************
- *@简介：
- ***使用static修饰定义一个任务对象，并初始化
+ *[f]: future
+ *
+ *@return value:
+ *[true]: reset success
+ *[false]: there are events awaiting the future
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***重置已完成的future，使其可以再次使用
  *
  *@参数：
- *[_name]：任务对象的名字
- *[task_func]：任务函数
- *[stack_size]：任务栈的大小
- *[priority]：任务事件的优先级
- *************************************************************/
-#define TASK_DEFINE_STATIC(_name, stack_size, priority)             \
-    static uint32_t _name##_stack_buf[(stack_size + 3) / 4];        \
-    static task_t  _name = TASK_STATIC_INIT(_name,                  \
-                                            _name##_stack_buf,      \
-                                            (stack_size),           \
-                                            (priority))
+ *[f]：future
+ *
+ *@返回值：
+ *[true]：重置成功
+ *[false]：存在等待future的事件
+ **********************************************************/
+static inline bool future_reset(future_t *f)
+{
+    if (acond_have_waiters(&f->waiters))
+    {
+        return false;
+    }
 
-/* The size of task context information to be saved when making an asynchronous call */
-/* 进行异步调用时需要保存的任务上下文信息大小 */
-#define TASK_STACK_CTX_SIZE (sizeof(struct task_cur_ctx_s) + sizeof(event_cb))
+    f->value.u64 = 0;
+    f->error = 0;
+    f->is_done = 0;
 
-/* Simple macro, return a - b to ensure greater than or equal to 0 */
-/* 简单的宏，返回a - b保证大于等于0 */
-#define _SUB_BEZ(a, b)  ((a) > (b) ? ((a) - (b)) : 0)
+    return true;
+}
 
 
-/************************************************************
- *@brief:
- ***Task data structure dynamic initialization,
- ***if the task has been statically initialized, 
- ***you don't have to use this function.
+/*********************************************************
+ *@brief: 
+ ***check whether the future is completed
  *
  *@parameter:
- *[task]: Task variable name, non-pointer
- *[task_func]: Task function
- *[stack]：Task stack
- *[stack_size]：Stack size
- *[priority]：Priority of task events
- *************************************************************/
-/************************************************************
- *@简介：
- ***任务数据结构动态初始化，若task已静态初始化，则不必使用该函数
+ *[f]: future
+ *
+ *@return value:
+ *[true]: completed
+ *[false]: not completed
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***检查future是否已完成
  *
  *@参数：
- *[task]：任务的变量名，非指针
- *[task_func]：任务函数
- *[stack]：任务的栈
- *[stack_size]：栈的大小
- *[priority]：任务事件的优先级
- *************************************************************/
-static inline void task_init(task_t *task, void *stack, size_t stack_size, uint8_t priority)
+ *[f]：future
+ *
+ *@返回值：
+ *[true]：已完成
+ *[false]：未完成
+ **********************************************************/
+static inline bool future_is_done(future_t *f)
 {
-    event_init(&task->event, (event_cb)NULL_CB, task, priority);
+    return f->is_done != 0;
+}
 
-    task->stack.start = (uint8_t *)ALIGN_UP((size_t)stack);
-    task->stack.end = task->stack.start + _SUB_BEZ(stack_size, (size_t)(task->stack.start - (uint8_t *)stack));
-    task->stack.cur = task->stack.start;
 
-    task->ret_val.ptr = NULL;
+/*********************************************************
+ *@brief: 
+ ***get the error code of the completed future
+ *
+ *@parameter:
+ *[f]: future
+ *
+ *@return: error code, 0 is success
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***获取已完成future的错误码
+ *
+ *@参数：
+ *[f]：future
+ *
+ *@返回：错误码，0为成功
+ **********************************************************/
+static inline int32_t future_error_get(future_t *f)
+{
+    return f->error;
+}
 
-    task->cur_ctx.stack_used = 0;
-    task->cur_ctx.bp = BP_INIT_VAL;
-    task->cur_ctx.yield_state = 0;
-    lifo_init(&task->task_end_notify_q);
+
+/*********************************************************
+ *@brief: 
+ ***get the value of the completed future
+ *
+ *@parameter:
+ *[f]: future
+ *[member]: value type, ptr, u64, s64, u32 or s32
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***获取已完成future的值
+ *
+ *@参数：
+ *[f]：future
+ *[member]：值类型，ptr、u64、s64、u32或s32
+ **********************************************************/
+#define FUTURE_VALUE(f, member)     ((f)->value.member)
+
+
+/*********************************************************
+ *@brief: 
+ ***complete the future with the value already stored in it
+ ***and the error code, wake up all awaiting events
+ *
+ *@parameter:
+ *[f]: future
+ *[error]: error code, 0 is success
+ *
+ *@return value:
+ *[true]: completed
+ *[false]: the future was already completed
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***以future中已存储的值与错误码完成future，唤醒所有等待事件
+ *
+ *@参数：
+ *[f]：future
+ *[error]：错误码，0为成功
+ *
+ *@返回值：
+ *[true]：完成
+ *[false]：future已经完成过
+ **********************************************************/
+static inline bool future_complete(future_t *f, int32_t error)
+{
+    if (f->is_done)
+    {
+        return false;
+    }
+
+    f->error = error;
+    f->is_done = 1;
+    acond_broadcast(&f->waiters);
+
+    return true;
 }
 
 
-/************************************************************
- *@brief:
- ***start task
+/*********************************************************
+ *@brief: 
+ ***complete the future with a value
  *
  *@parameter:
- *[task]: Task object, cannot be empty
- *************************************************************/
-/************************************************************
- *@简介：
- ***启动任务
+ *[f]: future
+ *[val]: result value
+ *
+ *@return value:
+ *[true]: completed
+ *[false]: the future was already completed
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***以一个值完成future
  *
  *@参数：
- *[task]：任务对象，不能为空
- *[task_func]: 任务函数，任务函数应该被声明为 void task_func(task_t *task, event_t *ev, 参数1, 参数2..)格式
- *[...]: 任务函数的第3个及之后的参数
- *************************************************************/
-#define task_start(task, task_func, ...)                        \
-    do {                                                        \
-        EVENT_CALLBACK(&(task)->event) = (event_cb)(task_func); \
-        (task_func)((task), NULL, ##__VA_ARGS__);               \
-    } while (0)
+ *[f]：future
+ *[val]：结果值
+ *
+ *@返回值：
+ *[true]：完成
+ *[false]：future已经完成过
+ **********************************************************/
+/* store the value and complete, the value of a completed future is not overwritten */
+/* 存储值并完成，已完成future的值不会被覆盖 */
+#define _future_private_resolve(f, member, val)                     \
+    (!(f)->is_done && ((f)->value.member = (val), future_complete((f), 0)))
+
+static inline bool future_resolve_ptr(future_t *f, void *val)
+{
+    return _future_private_resolve(f, ptr, val);
+}
+
+static inline bool future_resolve_u64(future_t *f, uint64_t val)
+{
+    return _future_private_resolve(f, u64, val);
+}
+
+static inline bool future_resolve_s64(future_t *f, int64_t val)
+{
+    return _future_private_resolve(f, s64, val);
+}
+
+static inline bool future_resolve_u32(future_t *f, uint32_t val)
+{
+    return _future_private_resolve(f, u32, val);
+}
+
+static inline bool future_resolve_s32(future_t *f, int32_t val)
+{
+    return _future_private_resolve(f, s32, val);
+}
+
 
 /*********************************************************
  *@brief: 
- ***Get the asynchronous variables in the current task stack.
- ***
- ***task will generate the operation of allocating memory 
- ***when it is called for the first time. 
- ***After bpd_yield causes bp to not be 0,
- ***get again, return to the previous memory
+ ***complete the future with an error code
+ *
+ *@parameter:
+ *[f]: future
+ *[error]: error code, non-zero
+ *
+ *@return value:
+ *[true]: completed
+ *[false]: the future was already completed
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***以错误码完成future
+ *
+ *@参数：
+ *[f]：future
+ *[error]：错误码，非0
+ *
+ *@返回值：
+ *[true]：完成
+ *[false]：future已经完成过
+ **********************************************************/
+static inline bool future_reject(future_t *f, int32_t error)
+{
+    return future_complete(f, error);
+}
+
+
+/* future_await results */
+/* future_await结果 */
+#define FUTURE_AWAIT_BUSY       -1
+#define FUTURE_AWAIT_PENDING    0
+#define FUTURE_AWAIT_DONE       1
+
+/*********************************************************
+ *@brief: 
+ ***await the completion of the future
  *
  *@contract: 
- ***Cannot use null pointer
+ ***1. Cannot use null pointer
+ ***2. the event node is idle
+ *
+ *@parameter:
+ *[f]: future
+ *[ev]: the event of notification
+ *
+ *@return value:
+ *[FUTURE_AWAIT_DONE]: the future is already completed, the event is not used,
+ ***the result can be read immediately
+ *[FUTURE_AWAIT_PENDING]: the event will be triggered when the future is completed
+ *[FUTURE_AWAIT_BUSY]: the event node is in the queue or reference state,
+ ***the event is not used and the future is not completed
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***等待future完成
+ *
+ *@约定：
+ ***1、不能使用空指针
+ ***2、事件节点处于空闲状态
+ *
+ *@参数：
+ *[f]：future
+ *[ev]：通知事件
+ *
+ *@返回值：
+ *[FUTURE_AWAIT_DONE]：future已完成，事件未被使用，可立即读取结果
+ *[FUTURE_AWAIT_PENDING]：事件将在future完成时被触发
+ *[FUTURE_AWAIT_BUSY]：事件节点处于队列之中或者引用状态，事件未被使用，future未完成
+ **********************************************************/
+static inline int8_t future_await(future_t *f, event_t *ev)
+{
+    if (f->is_done)
+    {
+        return FUTURE_AWAIT_DONE;
+    }
+
+    if (!acond_wait(&f->waiters, ev))
+    {
+        return FUTURE_AWAIT_BUSY;
+    }
+
+    return FUTURE_AWAIT_PENDING;
+}
+
+
+/*********************************************************
+ *@brief:
+ ***cancel the event of future_await
+ *
+ *@parameter:
+ *[f]: future
+ *[ev]: the event used in future_await
+ *
+ *@return value:
+ *[true]: cancel success
+ *[false]: cancel failed
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***取消future_await的事件
+ *
+ *@参数：
+ *[f]：future
+ *[ev]: future_await中使用的事件
+ *
+ *@返回值：
+ *[true]：取消成功
+ *[false]：取消失败
+ **********************************************************/
+static inline bool future_await_cancel(future_t *f, event_t *ev)
+{
+    return acond_wait_cancel(&f->waiters, ev);
+}
+
+
+/*********************************************************
+ *@type description:
+ *
+ *[ratelimit_event_t]: rate limiter acquire event,
+ ***records the number of tokens to acquire
+ *********************************************************
+ *@类型说明：
+ *
+ *[ratelimit_event_t]：限速器获取事件，记录要获取的令牌数
+ *********************************************************/
+typedef struct ratelimit_event_s
+{
+    event_t event;
+    uint32_t tokens;
+} ratelimit_event_t;
+
+
+/************************************************************
+ *@brief:
+ ***rate limiter acquire event initialization
+ *
+ *@parameter:
+ *[rl_ev]: rate limiter acquire event
+ *[ecb]: event callback function
+ *[ctx]: callback context of the event
+ *[priority]: priority of the event
+ *[parent]: parent event (inherit)
+ *************************************************************/
+/************************************************************
+ *@简介：
+ ***限速器获取事件初始化
+ *
+ *@参数：
+ *[rl_ev]：限速器获取事件
+ *[ecb]：事件回调函数
+ *[ctx]：事件的回调上下文
+ *[priority]：事件的优先级
+ *[parent]：父事件（继承）
+ *************************************************************/
+#define ratelimit_event_init(rl_ev, ecb, ctx, priority)             \
+    do                                                              \
+    {                                                               \
+        event_init(&(rl_ev)->event, (ecb), (ctx), (priority));      \
+        (rl_ev)->tokens = 0;                                        \
+    } while (0)
+
+#define ratelimit_event_init_inherit(rl_ev, parent)                 \
+    do                                                              \
+    {                                                               \
+        event_init_inherit(&(rl_ev)->event, (parent));              \
+        (rl_ev)->tokens = 0;                                        \
+    } while (0)
+
+#define RATELIMIT_EVENT_OF_EVENT(_event) container_of(_event, ratelimit_event_t, event)
+
+#define RATELIMIT_EVENT_OF_NODE(node) container_of(EVENT_OF_NODE(node), ratelimit_event_t, event)
+
+
+/*********************************************************
+ *@type description:
+ *
+ *[ratelimit_t]: token bucket rate limiter,
+ ***tokens are refilled lazily from the clock,
+ ***the waiting events share one timer that is armed
+ ***for the refill time of the head waiter
+ *********************************************************
+ *@类型说明：
+ *
+ *[ratelimit_t]：令牌桶限速器，令牌根据时钟惰性补充，
+ ***等待的事件共享一个定时器，定时器按队首等待者的补充时间启动
+ *********************************************************/
+typedef struct ratelimit_s
+{
+    /* waiting acquire events */
+    /* 等待中的获取事件 */
+    fifo_t wait_q;
+
+    /* refill timer shared by the waiting events */
+    /* 等待事件共享的补充定时器 */
+    timer_event_t timer;
+
+    /* time of the last refill */
+    /* 最后一次补充的时间 */
+    time_nclk_t last;
+
+    /* clocks per token, 0 is no refill */
+    /* 每个令牌的时钟数，为0时不补充 */
+    time_nclk_t nclk_per_token;
+
+    /* bucket size */
+    /* 桶大小 */
+    uint32_t burst;
+
+    /* tokens in the bucket */
+    /* 桶中的令牌数 */
+    uint32_t tokens;
+} ratelimit_t;
+
+
+/* Refill tokens by the elapsed time since the last refill */
+/* 按上次补充以来经过的时间补充令牌 */
+static inline void _rl_private_refill(ratelimit_t *rl)
+{
+    time_nclk_t now = time_nclk_get();
+    time_nclk_t add;
+
+    if (rl->tokens >= rl->burst || rl->nclk_per_token == 0)
+    {
+        rl->last = now;
+        return;
+    }
+
+    add = (now - rl->last) / rl->nclk_per_token;
+    if (add >= rl->burst - rl->tokens)
+    {
+        rl->tokens = rl->burst;
+        rl->last = now;
+    }
+    else if (add > 0)
+    {
+        rl->tokens += (uint32_t)add;
+        rl->last += add * rl->nclk_per_token;
+    }
+}
+
+/* Grant tokens to the waiters in queue order,
+ * and arm the timer for the refill time of the head waiter */
+/* 按队列顺序为等待者分配令牌，并按队首等待者的补充时间启动定时器 */
+static inline void _rl_private_dispatch(ratelimit_t *rl)
+{
+    ratelimit_event_t *head;
+
+    el_timer_stop(&rl->timer);
+
+    if (fifo_is_empty(&rl->wait_q))
+    {
+        return;
+    }
+
+    _rl_private_refill(rl);
+
+    while (!fifo_is_empty(&rl->wait_q))
+    {
+        head = RATELIMIT_EVENT_OF_NODE(FIFO_TOP(&rl->wait_q));
+        if (head->tokens > rl->tokens)
+        {
+            if (rl->nclk_per_token)
+            {
+                el_timer_start_due(&rl->timer,
+                    rl->last + (head->tokens - rl->tokens) * rl->nclk_per_token);
+            }
+            break;
+        }
+
+        rl->tokens -= head->tokens;
+        el_event_post(event_fifo_priority_pop(&rl->wait_q));
+    }
+}
+
+static inline void _rl_private_on_timer(void *ctx, event_t *e)
+{
+    (void)e;
+
+    _rl_private_dispatch((ratelimit_t *)ctx);
+}
+
+/* Convert the rate to clocks per token */
+/* 将速率转换为每个令牌的时钟数 */
+static inline time_nclk_t _rl_private_nclk_per_token(uint32_t rate)
+{
+    time_nclk_t nclk;
+
+    if (rate == 0)
+    {
+        return 0;
+    }
+
+    nclk = time_us_to_nclk(1000000) / rate;
+
+    return nclk ? nclk : 1;
+}
+
+
+/*********************************************************
+ *@brief: 
+ ***rate limiter initialization, the bucket is initially full
+ *
+ *@contract: 
+ ***1. rl is not null pointer
+ ***2. cannot initialize the rate limiter being used
+ *
+ *@parameter:
+ *[rl]: rate limiter
+ *[rate]: tokens refilled per second, 0 is no refill
+ *[burst]: bucket size, the maximum number of tokens
+ *[priority]: priority of the refill timer
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***限速器初始化，桶初始为满
+ *
+ *@约定：
+ ***1、rl不是空指针
+ ***2、不可对正在使用的限速器进行初始化
+ *
+ *@参数：
+ *[rl]：限速器
+ *[rate]：每秒补充的令牌数，为0时不补充
+ *[burst]：桶大小，即令牌的最大数量
+ *[priority]：补充定时器的优先级
+ **********************************************************/
+static inline void rl_init(ratelimit_t *rl, uint32_t rate, uint32_t burst, uint8_t priority)
+{
+    fifo_init(&rl->wait_q);
+    timer_init(&rl->timer, _rl_private_on_timer, rl, priority);
+    rl->last = time_nclk_get();
+    rl->nclk_per_token = _rl_private_nclk_per_token(rate);
+    rl->burst = burst;
+    rl->tokens = burst;
+}
+
+
+/*********************************************************
+ *@brief: 
+ ***acquire n tokens without waiting,
+ ***fails when there are waiting events, so as not to jump the queue
+ *
+ *@parameter:
+ *[rl]: rate limiter
+ *[n]: number of tokens
+ *
+ *@return value:
+ *[true]: acquired
+ *[false]: not enough tokens or there are waiting events
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***不等待地获取n个令牌，存在等待事件时失败，以免插队
+ *
+ *@参数：
+ *[rl]：限速器
+ *[n]：令牌数
+ *
+ *@返回值：
+ *[true]：获取成功
+ *[false]：令牌不足或存在等待事件
+ **********************************************************/
+static inline bool rl_try_acquire(ratelimit_t *rl, uint32_t n)
+{
+    if (!fifo_is_empty(&rl->wait_q))
+    {
+        return false;
+    }
+
+    _rl_private_refill(rl);
+
+    if (rl->tokens < n)
+    {
+        return false;
+    }
+
+    rl->tokens -= n;
+
+    return true;
+}
+
+
+/*********************************************************
+ *@brief: 
+ ***acquire n tokens, the event is posted immediately when
+ ***the tokens are available, otherwise it waits in the queue
+ ***(higher priority first, first-in-first-out with the same priority)
+ ***and is posted when the refill satisfies it at the head of the queue
+ *
+ *@contract: 
+ ***1. Cannot use null pointer
+ ***2. n is not greater than the burst size
+ *
+ *@parameter:
+ *[rl]: rate limiter
+ *[n]: number of tokens
+ *[rl_ev]: the event of notification
+ *
+ *@return value:
+ *[true]: the event is posted or waiting
+ *[false]: the event node is in the queue or reference state,
+ ***or n is greater than the burst size
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***获取n个令牌，令牌可用时立即提交事件，
+ ***否则在队列中等待（高优先级优先，同优先级先进先出），
+ ***在队首且补充的令牌足够时提交事件
+ *
+ *@约定：
+ ***1、不能使用空指针
+ ***2、n不大于桶大小
+ *
+ *@参数：
+ *[rl]：限速器
+ *[n]：令牌数
+ *[rl_ev]：通知事件
+ *
+ *@返回值：
+ *[true]：事件已提交或正在等待
+ *[false]：事件节点处于队列之中或者引用状态，或n大于桶大小
+ **********************************************************/
+static inline bool rl_acquire(ratelimit_t *rl, uint32_t n, ratelimit_event_t *rl_ev)
+{
+    if (!slist_node_is_del(EVENT_NODE(&rl_ev->event)) || n > rl->burst)
+    {
+        return false;
+    }
+
+    rl_ev->tokens = n;
+
+    if (rl_try_acquire(rl, n))
+    {
+        el_event_post(&rl_ev->event);
+    }
+    else
+    {
+        event_fifo_priority_push(&rl->wait_q, &rl_ev->event);
+
+        if (FIFO_TOP(&rl->wait_q) == EVENT_NODE(&rl_ev->event))
+        {
+            _rl_private_dispatch(rl);
+        }
+    }
+
+    return true;
+}
+
+
+/*********************************************************
+ *@brief:
+ ***cancel the event of rl_acquire, the tokens granted to
+ ***an event that has not been triggered are returned to the bucket
+ *
+ *@parameter:
+ *[rl]: rate limiter
+ *[rl_ev]: the event used in rl_acquire
+ *
+ *@return value:
+ *[true]: cancel success
+ *[false]: cancel failed
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***取消rl_acquire的事件，已分配给未触发事件的令牌将归还到桶中
+ *
+ *@参数：
+ *[rl]：限速器
+ *[rl_ev]: rl_acquire中使用的事件
+ *
+ *@返回值：
+ *[true]：取消成功
+ *[false]：取消失败
+ **********************************************************/
+static inline bool rl_acquire_cancel(ratelimit_t *rl, ratelimit_event_t *rl_ev)
+{
+    if (slist_node_is_del(EVENT_NODE(&rl_ev->event)))
+    {
+        return false;
+    }
+
+    if (el_event_is_ready(&rl_ev->event))
+    {
+        if (!el_event_cancel(&rl_ev->event))
+        {
+            return false;
+        }
+
+        _rl_private_refill(rl);
+        rl->tokens = rl->burst - rl->tokens > rl_ev->tokens ? rl->tokens + rl_ev->tokens : rl->burst;
+    }
+    else if (!fifo_del_node(&rl->wait_q, EVENT_NODE(&rl_ev->event)))
+    {
+        return false;
+    }
+
+    _rl_private_dispatch(rl);
+
+    return true;
+}
+
+
+/*********************************************************
+ *@brief: 
+ ***modify the refill rate at runtime,
+ ***the tokens of the elapsed time are refilled at the old rate,
+ ***the partial token of the elapsed time is carried over at the new rate
+ *
+ *@parameter:
+ *[rl]: rate limiter
+ *[rate]: tokens refilled per second, 0 is no refill
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***运行时修改补充速率，已经过时间的令牌按旧速率补充，
+ ***不足一个令牌的部分按新速率折算后保留
+ *
+ *@参数：
+ *[rl]：限速器
+ *[rate]：每秒补充的令牌数，为0时不补充
+ **********************************************************/
+static inline void rl_rate_set(ratelimit_t *rl, uint32_t rate)
+{
+    time_nclk_t old_nclk = rl->nclk_per_token;
+    time_nclk_t new_nclk = _rl_private_nclk_per_token(rate);
+    time_nclk_t now;
+    time_nclk_t partial;
+
+    _rl_private_refill(rl);
+
+    /* after the refill, last is behind now by less than one token at the old rate,
+     * keep the same fraction of a token at the new rate */
+    /* 补充后last落后当前时间不足旧速率下的一个令牌，按新速率保留相同比例的令牌 */
+    now = time_nclk_get();
+    partial = now - rl->last;
+    if (old_nclk && new_nclk && partial)
+    {
+        while (partial > UINT64_MAX / new_nclk)
+        {
+            partial >>= 1;
+            old_nclk >>= 1;
+        }
+        rl->last = now - partial * new_nclk / old_nclk;
+    }
+    else
+    {
+        rl->last = now;
+    }
+
+    rl->nclk_per_token = new_nclk;
+    _rl_private_dispatch(rl);
+}
+
+
+/*********************************************************
+ *@brief: 
+ ***modify the bucket size at runtime, the tokens beyond
+ ***the new size are discarded
+ *
+ *@contract: 
+ ***1. the waiting events do not acquire more tokens than the new size
+ *
+ *@parameter:
+ *[rl]: rate limiter
+ *[burst]: bucket size
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***运行时修改桶大小，超出新大小的令牌被丢弃
+ *
+ *@约定：
+ ***1、等待中的事件获取的令牌数不大于新的桶大小
+ *
+ *@参数：
+ *[rl]：限速器
+ *[burst]：桶大小
+ **********************************************************/
+static inline void rl_burst_set(ratelimit_t *rl, uint32_t burst)
+{
+    _rl_private_refill(rl);
+    rl->burst = burst;
+    if (rl->tokens > burst)
+    {
+        rl->tokens = burst;
+    }
+    _rl_private_dispatch(rl);
+}
+
+
+#ifdef CONFIG_SLAB_GROWABLE
+
+/* page provider of the growable slab,
+ * the memory returned by alloc must be aligned to its size */
+/* 可增长slab的页提供者，alloc返回的内存必须按其大小对齐 */
+typedef struct slab_page_provider_s
+{
+    /* allocate a chunk of size bytes, aligned to size */
+    /* 分配size字节且按size对齐的chunk */
+    void *(*alloc)(void *ctx, size_t size);
+
+    /* free a chunk */
+    /* 释放chunk */
+    void (*free)(void *ctx, void *mem, size_t size);
+
+    /* provider context */
+    /* 提供者上下文 */
+    void *ctx;
+} slab_page_provider_t;
+
+/* chunk header, at the start of each chunk of the growable slab */
+/* chunk头部，位于可增长slab每个chunk的起始处 */
+typedef struct slab_chunk_s
+{
+    /* chunk list node */
+    /* chunk链表节点 */
+    slist_node_t node;
+
+    /* time since the chunk is fully free */
+    /* chunk完全空闲的起始时间 */
+    time_nclk_t free_since;
+
+    /* number of used blocks in the chunk */
+    /* chunk中已使用的块数 */
+    uint32_t nums_used;
+
+    /* the chunk is being released */
+    /* chunk正在被释放 */
+    uint8_t is_release;
+} slab_chunk_t;
+
+#endif /* CONFIG_SLAB_GROWABLE */
+
+#ifdef CONFIG_SLAB_STATS
+
+/* Number of buckets of the wait time histogram,
+ * bucket 0 counts waits under 1us, bucket i counts waits in [2^(i-1), 2^i) us, the last bucket counts the rest */
+/* 等待时间直方图的桶数，
+ * 桶0统计小于1us的等待，桶i统计[2^(i-1), 2^i) us的等待，最后一个桶统计其余的等待 */
+#ifndef CONFIG_SLAB_STATS_HIST_SIZE
+#define CONFIG_SLAB_STATS_HIST_SIZE     24
+#endif /* CONFIG_SLAB_STATS_HIST_SIZE */
+
+/* slab statistics */
+/* slab统计 */
+typedef struct slab_stats_s
+{
+    /* total number of blocks, filled by slab_stats_get */
+    /* 总块数，由slab_stats_get填写 */
+    uint32_t blk_nums;
+
+    /* number of used blocks, filled by slab_stats_get */
+    /* 已使用的块数，由slab_stats_get填写 */
+    uint32_t nums_used;
+
+    /* number of current waiters, filled by slab_stats_get */
+    /* 当前等待者个数，由slab_stats_get填写 */
+    uint32_t waiters;
+
+    /* peak number of used blocks */
+    /* 已使用块数的峰值 */
+    uint32_t peak_used;
+
+    /* number of allocated blocks, including the blocks handed to waiters */
+    /* 分配的块数，包括交给等待者的块 */
+    uint64_t allocs;
+
+    /* number of freed blocks, including the blocks handed to waiters */
+    /* 释放的块数，包括交给等待者的块 */
+    uint64_t frees;
+
+    /* number of failed allocations, including timed out waits */
+    /* 分配失败的次数，包括等待超时 */
+    uint64_t failed_allocs;
+
+    /* number of waits that were queued */
+    /* 进入等待队列的等待次数 */
+    uint64_t waits;
+
+    /* histogram of the wait time from slab_wait to the wake-up */
+    /* 从slab_wait到被唤醒的等待时间直方图 */
+    uint32_t wait_hist[CONFIG_SLAB_STATS_HIST_SIZE];
+} slab_stats_t;
+
+#endif /* CONFIG_SLAB_STATS */
+
+/* slab allocator definition */
+/* slab分配器定义 */
+typedef struct slab_s
+{
+    /* block size */
+    /* 块大小 */
+    uint32_t    blk_size;
+
+    /* number of block */
+    /* 块数 */
+    uint32_t    blk_nums;
+
+    /* number of used block */
+    /* 已使用的块数 */
+    uint32_t    nums_used;
+
+    /* record the original buff pointer */
+    /* 记录原始的buff指针 */
+    uint8_t     *buff;
+
+    /* slab available notification queue */
+    /* slab可用通知队列 */
+    fifo_t    notify_q;
+
+    /* free block list */
+    /* 空闲块链表 */
+    slist_t free_list;
+
+    /* high-water pointer, blocks from here have never been allocated */
+    /* 高水位指针，从此处开始的块从未被分配过 */
+    uint8_t     *bump;
+
+    /* end of the never allocated blocks */
+    /* 从未被分配过的块的结尾 */
+    uint8_t     *bump_end;
+
+#ifdef CONFIG_SLAB_GROWABLE
+    /* page provider, NULL for the slab of fixed buffer */
+    /* 页提供者，固定buffer的slab为NULL */
+    const slab_page_provider_t *provider;
+
+    /* chunk list */
+    /* chunk链表 */
+    slist_t chunks;
+
+    /* chunk size, power of two */
+    /* chunk大小，2的幂次 */
+    uint32_t chunk_size;
+
+    /* number of blocks per chunk */
+    /* 每个chunk的块数 */
+    uint32_t chunk_blk_nums;
+
+    /* colour step of the block offset between chunks, 0 disables colouring */
+    /* chunk间块偏移的着色步长，0表示不着色 */
+    uint32_t colour_size;
+
+    /* block offset of the next chunk */
+    /* 下一个chunk的块偏移 */
+    uint32_t colour_next;
+
+    /* time of a chunk stays fully free before it is released */
+    /* chunk被释放前需持续完全空闲的时间 */
+    time_nclk_t release_delay;
+
+    /* chunk release timer */
+    /* chunk释放定时器 */
+    timer_event_t release_timer;
+#endif /* CONFIG_SLAB_GROWABLE */
+
+#ifdef CONFIG_SLAB_STATS
+    /* statistics */
+    /* 统计 */
+    slab_stats_t stats;
+#endif /* CONFIG_SLAB_STATS */
+} slab_t;
+
+
+/* slab allocate event */
+/* slab分配事件 */
+typedef struct slab_alloc_event_s
+{
+    event_t event;
+    void *mem_blk;
+#ifdef CONFIG_SLAB_STATS
+    /* time the event starts waiting */
+    /* 事件开始等待的时间 */
+    time_nclk_t wait_since;
+#endif /* CONFIG_SLAB_STATS */
+} slab_alloc_event_t;
+
+
+/************************************************************
+ *@brief:
+ ***slab event structure static initialization
+ *
+ *@Usage:
+ ***slab_alloc_event_t slab_event
+ ***     = SLAB_ALLOC_EVENT_STATIC_INIT(slab_event, callback, ctx);
+ *
+ *@parameter:
+ *[slab_event]: slab event variable name, non-address
+ *[callback]: event callback function (valid when called with 2 arguments)
+ *[ctx]: callback context of the event (valid when called with 3 arguments)
+ *[priority]: priority of the event (valid when called with 4 arguments)
+ *[id]: ID of the event (valid when called with 5 arguments)
+ *[state]: state of the event (valid when called with 6 arguments)
+ *************************************************************/
+/************************************************************
+ *@简介：
+ ***分配器事件结构体静态初始化
+ *
+ *@用法：
+ ***slab_alloc_event_t slab_event
+ ***     = SLAB_ALLOC_EVENT_STATIC_INIT(slab_event, callback, ctx);
+ *
+ *@参数：
+ *[slab_event]：分配器事件变量名，非地址
+ *[callback]：事件回调函数
+ *[ctx]：事件的回调上下文
+ *[priority]：事件的优先级
+ *************************************************************/
+#define SLAB_ALLOC_EVENT_STATIC_INIT(slab_event, ecb, ctx, priority)    \
+{                                                                       \
+    EVENT_STATIC_INIT((slab_event).event, (ecb), (ctx), (priority)),    \
+    NULL                                                                \
+}
+
+#define slab_alloc_event_init(slab_event, ecb, ctx, priority)       \
+    do                                                              \
+    {                                                               \
+        event_init(&(slab_event)->event, (ecb), (ctx), (priority)); \
+        (slab_event)->mem_blk = NULL;                               \
+    } while (0)
+
+#define slab_alloc_event_init_inherit(slab_event, parent)           \
+    do                                                              \
+    {                                                               \
+        event_init_inherit(&(slab_event)->event, (parent));         \
+        (slab_event)->mem_blk = NULL;                               \
+    } while (0)
+
+
+#define SLAB_ALLOC_EVENT_EVENT(slab_event)  (&(slab_event)->event)
+
+#define SLAB_ALLOC_EVENT_NODE(slab_event)   EVENT_NODE(&(slab_event)->event)
+
+#define SLAB_ALLOC_EVENT_OF_EVENT(_event) container_of(_event, slab_alloc_event_t, event)
+
+#define SLAB_ALLOC_EVENT_OF_NODE(node) container_of(EVENT_OF_NODE(node), slab_alloc_event_t, event)
+
+#ifdef CONFIG_SLAB_STATS
+
+/* Clear the statistics */
+/* 清空统计 */
+static inline void _slab_private_stats_clear(slab_t *slab)
+{
+    slab_stats_t empty = {0};
+
+    slab->stats = empty;
+    slab->stats.peak_used = slab->nums_used;
+}
+
+/* Count n allocated blocks and update the peak, called after nums_used is updated */
+/* 统计n个已分配的块并更新峰值，在nums_used更新之后调用 */
+static inline void _slab_private_stats_alloc(slab_t *slab, uint32_t n)
+{
+    slab->stats.allocs += n;
+    if (slab->nums_used > slab->stats.peak_used)
+    {
+        slab->stats.peak_used = slab->nums_used;
+    }
+}
+
+/* Count n freed blocks */
+/* 统计n个已释放的块 */
+static inline void _slab_private_stats_free(slab_t *slab, uint32_t n)
+{
+    slab->stats.frees += n;
+}
+
+/* Count a failed allocation */
+/* 统计一次分配失败 */
+static inline void _slab_private_stats_fail(slab_t *slab)
+{
+    slab->stats.failed_allocs++;
+}
+
+/* Count a queued wait and record its start time */
+/* 统计一次进入队列的等待并记录其起始时间 */
+static inline void _slab_private_stats_wait(slab_t *slab, slab_alloc_event_t *alloc_event)
+{
+    slab->stats.waits++;
+    alloc_event->wait_since = time_nclk_get();
+}
+
+/* Count a freed block handed to a waiter, and its wait time */
+/* 统计交给等待者的已释放块及其等待时间 */
+static inline void _slab_private_stats_wake(slab_t *slab, slab_alloc_event_t *alloc_event)
+{
+    time_us_t us = time_nclk_to_us(time_nclk_get() - alloc_event->wait_since);
+    uint32_t bucket = 0;
+
+    while (us && bucket < CONFIG_SLAB_STATS_HIST_SIZE - 1)
+    {
+        us >>= 1;
+        bucket++;
+    }
+
+    slab->stats.allocs++;
+    slab->stats.frees++;
+    slab->stats.wait_hist[bucket]++;
+}
+
+#else
+
+#define _slab_private_stats_clear(slab)
+#define _slab_private_stats_alloc(slab, n)
+#define _slab_private_stats_free(slab, n)
+#define _slab_private_stats_fail(slab)
+#define _slab_private_stats_wait(slab, alloc_event)
+#define _slab_private_stats_wake(slab, alloc_event)
+
+#endif /* CONFIG_SLAB_STATS */
+
+/*********************************************
+ *@brief：get the original buffer pointer of slab
+ *
+ *@parameter:
+ *[slab]: slab allocator
+ *
+ *@return: the original buff of slab
+ *********************************************
+ */
+/*********************************************
+ *@简要：获取slab原始的buffer指针
+ *
+ *@参数
+ *[slab] slab分配器
+ *
+ *@返回：slab的原始的buff
+ *********************************************
+ */
+static inline void *slab_buff_get(slab_t *slab)
+{
+    return slab->buff;
+}
+
+
+/*********************************************
+ *@brief：get the total number of slab
+ *
+ *@parameter: 
+ *[slab] slab allocator
+ *
+ *@return: the total number of slab
+ *********************************************
+ */
+/*********************************************
+ *@简要：获取slab的总块数
+ *
+ *@参数：
+ *[slab] slab分配器
+ *
+ *@返回：slab总块数
+ *********************************************
+ */
+static inline uint32_t slab_blk_nums_get(slab_t *slab)
+{
+    return slab->blk_nums;
+}
+
+
+/*********************************************
+ *@brief: get the number of blocks used by slab
+ *
+ *@parameter:
+ *[slab] slab allocator
+ *
+ *@return: the number of blocks used by slab
+ *********************************************
+ */
+/*********************************************
+ *@简要：获取slab已使用的块数
+ *
+ *@参数：
+ *[slab] slab分配器
+ *
+ *@返回：slab已使用的块数
+ *********************************************
+ */
+static inline uint32_t slab_used_get(slab_t *slab)
+{
+    return slab->nums_used;
+}
+
+
+/*********************************************
+ *@brief: get the number of blocks unused by slab
+ *
+ *@parameter:
+ *[slab] slab allocator
+ *
+ *@return: the number of blocks unused by slab
+ *********************************************
+ */
+/*********************************************
+ *@简要：获取slab未使用的块数
+ *
+ *@参数：
+ *[slab] slab分配器
+ *
+ *@返回：slab未使用的块数
+ *********************************************
+ */
+static inline uint32_t slab_unused_get(slab_t *slab)
+{
+    return slab->blk_nums - slab->nums_used;
+}
+
+/*********************************************
+ *@brief: get the size of the slab block
+ *
+ *@parameter:
+ *[slab] slab allocator
+ *
+ *@return: the size of the slab block
+ *********************************************
+ */
+/*********************************************
+ *@简要：获取slab块的大小
+ *
+ *@参数：
+ *[slab] slab分配器
+ *
+ *@返回：slab块的大小
+ *********************************************
+ */
+static inline uint32_t slab_blk_size_get(slab_t *slab)
+{
+    return slab->blk_size;
+}
+
+
+/*********************************************
+ *@brief: Initialize a slab allocator with a buffer in bump-pointer mode,
+ ***the blocks are not linked into the free list at initialization,
+ ***blocks never allocated are handed out from a high-water pointer,
+ ***only freed blocks go onto the free list.
+ ***the initialization is O(1), and only the pages of the blocks
+ ***actually used are touched
+ *
+ *@param:
+ *[slab]     slab
+ *[buff]     buffer
+ *[buf_size] size of buffer
+ *[blk_size] size of per block
+ *********************************************
+ */
+/*********************************************
+ *@简要：以高水位指针模式使用buffer初始化一个slab分配器，
+ ***初始化时不将块链接到空闲链表，从未分配过的块由高水位指针分配，
+ ***只有被释放的块才进入空闲链表。
+ ***初始化为O(1)，只有实际使用过的块所在的页会被访问
+ *
+ *@参数：
+ *[slab]	 slab
+ *[buff]     buffer
+ *[buf_size] buffer大小
+ *[blk_size] 每块的大小
+ *********************************************
+ */
+static inline void slab_init_lazy(slab_t *slab, void *buff, uint32_t buf_size, uint32_t blk_size)
+{
+    uint8_t *align_buff;
+    uint32_t size;
+
+    /* pointer alignment */
+    /* 指针向上取整对齐 */
+    align_buff = (uint8_t *)ALIGN_UP((size_t)buff);
+
+    /* size alignment */
+    /* 计算对齐后，可用size */
+    size = ALIGN_DOWN((uint8_t *)buff + buf_size - align_buff);
+
+	/* blk_size cpu-byte alignment */
+	/* blk_size CPU字节对齐 */
+	slab->blk_size = (uint32_t)ALIGN_UP(blk_size);
+
+	/* calculate the number of total blocks */
+	/* 重新计算总的块数 */
+	slab->blk_nums = size / slab->blk_size;
+
+	slab->nums_used = 0;
+
+	/* record buff */
+	/* 记录buff */
+	slab->buff = align_buff;
+
+	fifo_init(&slab->notify_q);
+
+	/* initialize the free list */
+	/* 初始化空闲块链表 */
+	slist_init((slist_t *)&slab->free_list);
+
+	/* all blocks are allocated from the high-water pointer */
+	/* 所有块均由高水位指针分配 */
+	slab->bump = align_buff;
+	slab->bump_end = align_buff + (size_t)slab->blk_nums * slab->blk_size;
+
+#ifdef CONFIG_SLAB_GROWABLE
+	slab->provider = NULL;
+	slist_init(&slab->chunks);
+#endif
+
+	_slab_private_stats_clear(slab);
+}
+
+/*********************************************
+ *@brief: initialize a slab allocator using buffer initialization
+ *
+ *@parameter:
+ *[slab] slab allocator
+ *[buff] buffer
+ *[blk_nums] total number of blocks
+ *[blk_size] the size of each block
+ *********************************************
+ */
+/*********************************************
+ *@简要：使用buffer初始化一个slab分配器
+ *
+ *@参数：
+ *[slab]	 slab
+ *[buff]     buffer
+ *[blk_nums] buffer大小
+ *[blk_size] 每块的大小
+ *********************************************
+ */
+static inline void slab_init(slab_t *slab, void *buff, uint32_t buf_size, uint32_t blk_size)
+{
+    uint8_t *free_node;
+    uint32_t i;
+
+    slab_init_lazy(slab, buff, buf_size, blk_size);
+
+	/* generates a free block list */
+	/* 生成空闲块链表 */
+	free_node = slab->bump;
+	for (i = 0; i < slab->blk_nums; i++)
+	{
+		slist_node_insert_next(SLIST_HEAD(&slab->free_list), (slist_node_t *)free_node);
+		free_node += slab->blk_size;
+	}
+
+	slab->bump = slab->bump_end;
+}
+
+/*********************************************
+ *@brief: initialize a slab allocator using array initialization
+ *
+ *@parameter:
+ *[slab] slab allocator
+ *[arr] array
+ *********************************************
+ */
+/*********************************************
+ *@简要：使用数组初始化一个slab分配器
+ *
+ *@参数：
+ *[slab]	slab
+ *[arr]     数组
+ *********************************************
+ */
+#define slab_init_by_arr(slab, arr)		slab_init((slab), (arr), sizeof(arr), sizeof((arr)[0]))
+
+#ifdef CONFIG_SLAB_GROWABLE
+
+/* Get the chunk of the block of the growable slab */
+/* 获取可增长slab中块所属的chunk */
+static inline slab_chunk_t *_slab_private_chunk_of(slab_t *slab, void *mem)
+{
+    return (slab_chunk_t *)((size_t)mem & ~((size_t)slab->chunk_size - 1));
+}
+
+/* Request a chunk from the page provider and link its blocks to the free list */
+/* 向页提供者申请chunk，并将其中的块链接到空闲链表 */
+static inline bool _slab_private_grow(slab_t *slab)
+{
+    slab_chunk_t *chunk;
+
+    if (slab->provider == NULL || slab->chunk_blk_nums == 0)
+    {
+        return false;
+    }
+
+    chunk = (slab_chunk_t *)slab->provider->alloc(slab->provider->ctx, slab->chunk_size);
+    if (chunk == NULL)
+    {
+        return false;
+    }
+
+    chunk->free_since = time_nclk_get();
+    chunk->nums_used = 0;
+    chunk->is_release = 0;
+    slist_node_insert_next(SLIST_HEAD(&slab->chunks), &chunk->node);
+
+    /* the blocks of the new chunk are allocated from the high-water pointer,
+     * the start is shifted by the colour so that the same block of each chunk falls into different cache sets */
+    /* 新chunk的块由高水位指针分配，
+     * 起始位置按着色偏移，使各chunk中相同位置的块落在不同的缓存组 */
+    slab->bump = (uint8_t *)chunk + ALIGN_UP(sizeof(slab_chunk_t)) + slab->colour_next;
+    slab->bump_end = slab->bump + (size_t)slab->chunk_blk_nums * slab->blk_size;
+
+    if (slab->colour_size)
+    {
+        slab->colour_next += slab->colour_size;
+        if (ALIGN_UP(sizeof(slab_chunk_t)) + slab->colour_next + (size_t)slab->chunk_blk_nums * slab->blk_size > slab->chunk_size)
+        {
+            slab->colour_next = 0;
+        }
+    }
+
+    slab->blk_nums += slab->chunk_blk_nums;
+
+    return true;
+}
+
+/* Release the chunks that have been fully free for the release delay */
+/* 释放已持续完全空闲release delay时间的chunk */
+static inline void _slab_private_on_release(void *ctx, event_t *e)
+{
+    slab_t *slab = (slab_t *)ctx;
+    time_nclk_t now = time_nclk_get();
+    time_nclk_t next_due = 0;
+    slab_chunk_t *chunk;
+    slist_node_t *cur_node;
+    slist_node_t *prev_node;
+    slist_node_t *safe_node;
+    bool have_release = false;
+
+    (void)e;
+
+    /* mark the chunks to release */
+    /* 标记需要释放的chunk */
+    slist_foreach(&slab->chunks, cur_node)
+    {
+        chunk = slist_entry(slab_chunk_t, node, cur_node);
+        if (chunk->nums_used == 0)
+        {
+            if (now - chunk->free_since >= slab->release_delay)
+            {
+                chunk->is_release = 1;
+                have_release = true;
+            }
+            else if (next_due == 0 || chunk->free_since + slab->release_delay < next_due)
+            {
+                next_due = chunk->free_since + slab->release_delay;
+            }
+        }
+    }
+
+    if (have_release)
+    {
+        /* unlink the free blocks of the marked chunks */
+        /* 移除被标记chunk的空闲块 */
+        slist_foreach_record_prev_safe(&slab->free_list, cur_node, prev_node, safe_node)
+        {
+            if (_slab_private_chunk_of(slab, cur_node)->is_release)
+            {
+                slist_node_del_next_safe(prev_node, &safe_node);
+            }
+        }
+
+        /* return the marked chunks to the provider */
+        /* 将被标记的chunk归还给页提供者 */
+        slist_foreach_record_prev_safe(&slab->chunks, cur_node, prev_node, safe_node)
+        {
+            chunk = slist_entry(slab_chunk_t, node, cur_node);
+            if (chunk->is_release)
+            {
+                if (slab->bump > (uint8_t *)chunk && slab->bump <= (uint8_t *)chunk + slab->chunk_size)
+                {
+                    slab->bump = slab->bump_end = NULL;
+                }
+
+                slist_node_del_next_safe(prev_node, &safe_node);
+                slab->blk_nums -= slab->chunk_blk_nums;
+                slab->provider->free(slab->provider->ctx, chunk, slab->chunk_size);
+            }
+        }
+    }
+
+    if (next_due)
+    {
+        el_timer_start_due(&slab->release_timer, next_due);
+    }
+}
+
+#endif /* CONFIG_SLAB_GROWABLE */
+
+/*********************************************
+ *@brief: Check whether the slab has a free block,
+ ***either on the free list or never allocated
+ *
+ *@param:
+ *[slab] slab allocator
+ *
+ *@return:
+ *[true] there is a free block
+ *[false] no free block
+ *********************************************
+ */
+/*********************************************
+ *@简要：检查slab是否有空闲块，包括空闲链表中的块与从未分配过的块
+ *
+ *@参数：
+ *[slab] slab分配器
+ *
+ *@返回：
+ *[true] 有空闲块
+ *[false] 没有空闲块
+ *********************************************
+ */
+static inline bool slab_have_free(slab_t *slab)
+{
+    return !slist_is_empty(&slab->free_list) || slab->bump < slab->bump_end;
+}
+
+/* Take a block from the free list, or from the high-water pointer */
+/* 从空闲链表或高水位指针取出一个块 */
+static inline void *_slab_private_blk_take(slab_t *slab)
+{
+    void *mem;
+
+    if (!slist_is_empty(&slab->free_list))
+    {
+        mem = (void *)slist_node_del_next(SLIST_HEAD(&slab->free_list));
+    }
+    else
+    {
+        mem = slab->bump;
+        slab->bump += slab->blk_size;
+    }
+
+    slab->nums_used++;
+    _slab_private_stats_alloc(slab, 1);
+
+#ifdef CONFIG_SLAB_GROWABLE
+    if (slab->provider)
+    {
+        _slab_private_chunk_of(slab, mem)->nums_used++;
+    }
+#endif
+
+    return mem;
+}
+
+/* Put a block back to the free list */
+/* 将块放回空闲链表 */
+static inline void _slab_private_blk_put(slab_t *slab, void *mem)
+{
+#ifdef CONFIG_SLAB_GROWABLE
+    slab_chunk_t *chunk;
+#endif
+
+    slist_node_insert_next(SLIST_HEAD(&slab->free_list), (slist_node_t *)mem);
+
+    slab->nums_used--;
+    _slab_private_stats_free(slab, 1);
+
+#ifdef CONFIG_SLAB_GROWABLE
+    if (slab->provider)
+    {
+        chunk = _slab_private_chunk_of(slab, mem);
+        if (--chunk->nums_used == 0)
+        {
+            chunk->free_since = time_nclk_get();
+            el_timer_start_nclk(&slab->release_timer, slab->release_delay);
+        }
+    }
+#endif
+}
+
+/* Check whether there is a free block, grow the growable slab if not */
+/* 检查是否有空闲块，若没有则增长可增长的slab */
+static inline bool _slab_private_have_free(slab_t *slab)
+{
+#ifdef CONFIG_SLAB_GROWABLE
+    return slab_have_free(slab) || _slab_private_grow(slab);
+#else
+    return slab_have_free(slab);
+#endif
+}
+
+#ifdef CONFIG_SLAB_GROWABLE
+
+/*********************************************
+ *@brief: Initialize a growable slab, the slab has no buffer at first,
+ ***chunks are requested from the page provider when the free list is empty,
+ ***and are returned after they stay fully free for release_delay_ms
+ *
+ *@contract:
+ ***1. chunk_size is a power of two
+ ***2. the provider returns memory aligned to chunk_size
+ ***3. a chunk can hold at least one block
+ *
+ *@param:
+ *[slab] slab allocator
+ *[blk_size] size of the memory block
+ *[chunk_size] size of the chunk requested from the provider
+ *[provider] page provider
+ *[release_delay_ms] time of a chunk stays fully free before it is released
+ *********************************************
+ */
+/*********************************************
+ *@简要：初始化可增长的slab，slab初始没有buffer，
+ ***在空闲链表为空时向页提供者申请chunk，
+ ***chunk持续完全空闲release_delay_ms后归还
+ *
+ *@约定：
+ ***1、chunk_size为2的幂次
+ ***2、页提供者返回按chunk_size对齐的内存
+ ***3、一个chunk至少能容纳一个块
+ *
+ *@参数：
+ *[slab] slab分配器
+ *[blk_size] 内存块的大小
+ *[chunk_size] 向页提供者申请的chunk大小
+ *[provider] 页提供者
+ *[release_delay_ms] chunk被释放前需持续完全空闲的时间
+ *********************************************
+ */
+static inline void slab_init_growable(slab_t *slab,
+                                      uint32_t blk_size,
+                                      uint32_t chunk_size,
+                                      const slab_page_provider_t *provider,
+                                      time_ms_t release_delay_ms)
+{
+    slab->blk_size = (uint32_t)ALIGN_UP(blk_size);
+    slab->blk_nums = 0;
+    slab->nums_used = 0;
+    slab->buff = NULL;
+    fifo_init(&slab->notify_q);
+    slist_init(&slab->free_list);
+    slab->bump = NULL;
+    slab->bump_end = NULL;
+
+    slab->provider = provider;
+    slist_init(&slab->chunks);
+    slab->chunk_size = chunk_size;
+    slab->chunk_blk_nums = (uint32_t)((chunk_size - ALIGN_UP(sizeof(slab_chunk_t))) / slab->blk_size);
+    slab->colour_size = 0;
+    slab->colour_next = 0;
+    slab->release_delay = time_us_to_nclk(release_delay_ms * 1000);
+    timer_init(&slab->release_timer, _slab_private_on_release, slab, LOWER_GROUP_PRIORITY);
+
+    _slab_private_stats_clear(slab);
+}
+
+
+/*********************************************
+ *@brief: Set the colour step of the growable slab, the block offset of each new chunk
+ ***advances by colour_size within the unused tail of the chunk and wraps to 0,
+ ***so that blocks at the same position of different chunks do not map to the same cache sets
+ *
+ *@contract:
+ ***1. colour_size is usually the cache line size, 0 disables colouring
+ ***2. only affects the chunks requested afterwards
+ *
+ *@param:
+ *[slab] slab allocator
+ *[colour_size] colour step
+ *********************************************
+ */
+/*********************************************
+ *@简要：设置可增长slab的着色步长，每个新chunk的块偏移在chunk尾部的剩余空间内
+ ***按colour_size递增并回绕到0，使不同chunk相同位置的块不映射到相同的缓存组
+ *
+ *@约定：
+ ***1、colour_size通常为缓存行大小，0表示不着色
+ ***2、只影响之后申请的chunk
+ *
+ *@参数：
+ *[slab] slab分配器
+ *[colour_size] 着色步长
+ *********************************************
+ */
+static inline void slab_colour_set(slab_t *slab, uint32_t colour_size)
+{
+    slab->colour_size = (uint32_t)ALIGN_UP(colour_size);
+    slab->colour_next = 0;
+}
+
+#endif /* CONFIG_SLAB_GROWABLE */
+
+
+/*********************************************
+ *@brief: the slab allocator allocate memory block
+ *
+ *@param:
+ *[slab] slab allocator
+ *
+ *@return: memory block
+ *********************************************
+ */
+/*********************************************
+ *@简要：slab分配器分配内存块
+ *
+ *@参数：
+ *[slab] slab分配器
+ *
+ *@返回： 内存块
+ *********************************************
+ */
+static inline void *slab_alloc(slab_t *slab)
+{
+    /* cannot allocate memory when the queue is empty */
+    /* 当队列为空时，不能进行内存分配 */
+    if (!_slab_private_have_free(slab))
+    {
+        _slab_private_stats_fail(slab);
+        return NULL;
+    }
+
+    /* take a free node */
+    /* 取出一个空闲节点，并返回 */
+    return _slab_private_blk_take(slab);
+}
+
+
+/*********************************************
+ *@brief: the slab allocator free memory block
+ *
+ *@parameter:
+ *[slab] slab allocator
+ *[mem] slab block
+ *
+ *@return: N/A
+ *********************************************
+ */
+/*********************************************
+ *@简要：slab分配器释放内存块
+ *
+ *@参数：
+ *[slab] slab分配器
+ *[mem] 内存块
+ *
+ *@返回：无
+ *********************************************
+ */
+static inline void slab_free(slab_t *slab, void *mem)
+{
+    slab_alloc_event_t *alloc_event;
+
+    /* notification waiter slab is available */
+    /* 通知等待者slab已可用 */
+    if (!fifo_is_empty(&slab->notify_q))
+    {
+        alloc_event = SLAB_ALLOC_EVENT_OF_EVENT(event_fifo_priority_pop(&slab->notify_q));
+        alloc_event->mem_blk = mem;
+        _slab_private_stats_wake(slab, alloc_event);
+        el_event_post(&alloc_event->event);
+    }
+    else
+    {
+        /* insert the node into the queue */
+        /* 将节点插入队列 */
+        _slab_private_blk_put(slab, mem);
+    }
+}
+
+
+/*********************************************
+ *@brief: the slab allocator allocates up to n memory blocks at once,
+ ***blocks on the free list are detached in one pass,
+ ***the rest come from the never allocated blocks
+ *
+ *@param:
+ *[slab] slab allocator
+ *[blks] array receiving the memory blocks
+ *[n] number of blocks to allocate
+ *
+ *@return: number of blocks allocated, less than n when the slab is exhausted
+ *********************************************
+ */
+/*********************************************
+ *@简要：slab分配器一次分配最多n个内存块，
+ ***一次遍历取下空闲链表中的块，其余由从未分配过的块提供
+ *
+ *@参数：
+ *[slab] slab分配器
+ *[blks] 接收内存块的数组
+ *[n] 需要分配的块数
+ *
+ *@返回：分配的块数，slab耗尽时小于n
+ *********************************************
+ */
+static inline uint32_t slab_alloc_bulk(slab_t *slab, void **blks, uint32_t n)
+{
+    slist_node_t *node = SLIST_NODE_NEXT(SLIST_HEAD(&slab->free_list));
+    slist_node_t *next;
+    uint32_t got = 0;
+
+    /* detach blocks from the free list */
+    /* 从空闲链表中取下块 */
+    while (got < n && node != SLIST_HEAD(&slab->free_list))
+    {
+        next = SLIST_NODE_NEXT(node);
+        node->next = node;
+        blks[got++] = node;
+        node = next;
+    }
+    SLIST_HEAD(&slab->free_list)->next = node;
+
+    /* the rest from the high-water pointer */
+    /* 其余由高水位指针分配 */
+    while (got < n)
+    {
+        if (slab->bump >= slab->bump_end)
+        {
+#ifdef CONFIG_SLAB_GROWABLE
+            if (!_slab_private_grow(slab))
+            {
+                break;
+            }
+#else
+            break;
+#endif
+        }
+
+        blks[got++] = slab->bump;
+        slab->bump += slab->blk_size;
+    }
+
+    slab->nums_used += got;
+    _slab_private_stats_alloc(slab, got);
+    if (got < n)
+    {
+        _slab_private_stats_fail(slab);
+    }
+
+#ifdef CONFIG_SLAB_GROWABLE
+    if (slab->provider)
+    {
+        for (n = 0; n < got; n++)
+        {
+            _slab_private_chunk_of(slab, blks[n])->nums_used++;
+        }
+    }
+#endif
+
+    return got;
+}
+
+
+/*********************************************
+ *@brief: the slab allocator frees a chain of n memory blocks linked by their first word,
+ ***the chain is spliced into the free list at once,
+ ***it is freed block by block when there are waiters of slab_wait or the slab is growable
+ *
+ *@param:
+ *[slab] slab allocator
+ *[first] first block of the chain
+ *[last] last block of the chain, its link is ignored
+ *[n] number of blocks in the chain
+ *********************************************
+ */
+/*********************************************
+ *@简要：slab分配器释放一条由块首字链接的n个内存块的链，
+ ***链一次拼接到空闲链表，
+ ***存在slab_wait的等待者或slab为可增长时逐块释放
+ *
+ *@参数：
+ *[slab] slab分配器
+ *[first] 链的第一个块
+ *[last] 链的最后一个块，其链接被忽略
+ *[n] 链中的块数
+ *********************************************
+ */
+static inline void slab_free_chain(slab_t *slab, void *first, void *last, uint32_t n)
+{
+    slist_node_t *node = (slist_node_t *)first;
+    slist_node_t *next;
+
+#ifdef CONFIG_SLAB_GROWABLE
+    if (!fifo_is_empty(&slab->notify_q) || slab->provider)
+#else
+    if (!fifo_is_empty(&slab->notify_q))
+#endif
+    {
+        /* the waiters and the chunks need to be handled one by one */
+        /* 等待者与chunk需要逐个处理 */
+        for (; n; n--)
+        {
+            next = SLIST_NODE_NEXT(node);
+            slab_free(slab, node);
+            node = next;
+        }
+
+        return;
+    }
+
+    slab->nums_used -= n;
+    _slab_private_stats_free(slab, n);
+    ((slist_node_t *)last)->next = SLIST_NODE_NEXT(SLIST_HEAD(&slab->free_list));
+    SLIST_HEAD(&slab->free_list)->next = (slist_node_t *)first;
+}
+
+
+/*********************************************
+ *@brief: the slab allocator frees n memory blocks at once,
+ ***the blocks are handed to the waiters of slab_wait first,
+ ***in priority order, the waiters of each ready group are spliced into
+ ***the event loop at once, the rest are spliced into the free list
+ *
+ *@param:
+ *[slab] slab allocator
+ *[blks] memory blocks
+ *[n] number of blocks
+ *********************************************
+ */
+/*********************************************
+ *@简要：slab分配器一次释放n个内存块，
+ ***优先按优先级顺序将块交给slab_wait的等待者，每个就绪组的等待者一次拼接到事件循环，
+ ***其余的块一次拼接到空闲链表
+ *
+ *@参数：
+ *[slab] slab分配器
+ *[blks] 内存块
+ *[n] 块数
+ *********************************************
+ */
+static inline void slab_free_bulk(slab_t *slab, void **blks, uint32_t n)
+{
+    fifo_t wake_groups[READY_GROUP_COUNT];
+    slab_alloc_event_t *alloc_event;
+    uint32_t first;
+    uint32_t i = 0;
+    uint8_t g;
+
+    /* hand the blocks to the waiters */
+    /* 将块交给等待者 */
+    if (!fifo_is_empty(&slab->notify_q))
+    {
+        for (g = 0; g < READY_GROUP_COUNT; g++)
+        {
+            fifo_init(&wake_groups[g]);
+        }
+
+        for (; i < n && !fifo_is_empty(&slab->notify_q); i++)
+        {
+            alloc_event = SLAB_ALLOC_EVENT_OF_EVENT(event_fifo_priority_pop(&slab->notify_q));
+            alloc_event->mem_blk = blks[i];
+            alloc_event->event.is_ready = 1;
+            _slab_private_stats_wake(slab, alloc_event);
+            fifo_push(&wake_groups[alloc_event->event.priority >> READY_GROUP_PRIORITY_SHIFT],
+                        EVENT_NODE(&alloc_event->event));
+        }
+
+        for (g = 0; g < READY_GROUP_COUNT; g++)
+        {
+            _el_private_events_splice(&wake_groups[g], g);
+        }
+    }
+
+    if (i >= n)
+    {
+        return;
+    }
+
+    /* link the rest into a chain and splice it into the free list */
+    /* 将其余块链接成链，并拼接到空闲链表 */
+    first = i;
+    for (; i + 1 < n; i++)
+    {
+        ((slist_node_t *)blks[i])->next = (slist_node_t *)blks[i + 1];
+    }
+    slab_free_chain(slab, blks[first], blks[i], n - first);
+}
+
+
+/*********************************************
+ *@brief: wait for the slab allocator to have a memory block available
+ *
+ *@param:
+ *[slab] slab allocator
+ *
+ *@return:
+ *[true] the slab allocator adds events successfully
+ *[false] events are in other queues and cannot be enqueue
+ *********************************************
+ */
+/*********************************************
+ *@简要：等待slab分配器有内存块可用
+ *
+ *@参数：
+ *[slab] slab分配器
+ *
+ *@返回：
+ *[true] slab分配器添加事件成功
+ *[false] 事件以处于其他队列中，不能入队
+ *********************************************
+ */
+static inline bool slab_wait(slab_t *slab, slab_alloc_event_t *alloc_event)
+{
+    /* 将事件添加到等待列表 */
+    if (slist_node_is_del(SLAB_ALLOC_EVENT_NODE(alloc_event)))
+    {
+        event_fifo_priority_push(&slab->notify_q, SLAB_ALLOC_EVENT_EVENT(alloc_event));
+
+        /* 若有内存可用，则唤醒等待队列中的一个事件 */
+        if (_slab_private_have_free(slab))
+        {
+            alloc_event = SLAB_ALLOC_EVENT_OF_EVENT(event_fifo_priority_pop(&slab->notify_q));
+            alloc_event->mem_blk = _slab_private_blk_take(slab);
+            el_event_post(&alloc_event->event);
+        }
+        else
+        {
+            _slab_private_stats_wait(slab, alloc_event);
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+
+/*********************************************
+ *@brief: Cancel the event waiting for the slab allocator
+ *
+ *@contract: slab_wait_cancel can only cancel events waiting by slab_wait
+ * 
+ *@param:
+ *[slab] slab allocator
+ *[alloc_event] allocator event
+ *
+ *@return:
+ *[true] Cancel the slab allocator event successfully
+ *[false] Slab allocator event is not in the wait queue
+ *********************************************
+ */
+/*********************************************
+ *@简要：取消等待slab分配器的事件
+ *
+ *@约定：slab_wait_cancel只能取消由slab_wait等待的事件
+ * 
+ *@参数：
+ *[slab] slab分配器
+ *[alloc_event] 分配器事件
+ *
+ *@返回：
+ *[true] 取消slab分配器事件成功
+ *[false] slab分配器事件不处于等待队列中
+ *********************************************
+ */
+static inline bool slab_wait_cancel(slab_t *slab, slab_alloc_event_t *alloc_event)
+{
+    if (el_event_is_ready(&alloc_event->event))
+    {
+        slab_free(slab, alloc_event->mem_blk);
+        alloc_event->mem_blk = NULL;
+
+        return el_event_cancel(&alloc_event->event);
+    }
+
+    return fifo_del_node(&slab->notify_q, EVENT_NODE(&alloc_event->event));
+}
+
+/*********************************************************
+ *@type description:
+ *
+ *[slab_timed_alloc_event_t]: slab allocate event with timeout,
+ ***the internal timer removes the event from the notify_q
+ ***of the slab when it expires
+ *********************************************************
+ *@类型说明：
+ *
+ *[slab_timed_alloc_event_t]：带超时的slab分配事件，
+ ***内部定时器到期时将事件从slab的notify_q中移除
+ *********************************************************/
+typedef struct slab_timed_alloc_event_s
+{
+    /* allocate event, queued in the notify_q of the slab */
+    /* 分配事件，在slab的notify_q中排队 */
+    slab_alloc_event_t alloc_event;
+
+    /* timeout timer */
+    /* 超时定时器 */
+    timer_event_t timer;
+
+    /* the slab being waited on */
+    /* 正在等待的slab */
+    slab_t *slab;
+
+    /* callback and context of the waiter */
+    /* 等待者的回调与上下文 */
+    event_cb notify_cb;
+    void *notify_ctx;
+} slab_timed_alloc_event_t;
+
+
+/* Allocate event arrives, stop the timer and notify the waiter */
+/* 分配事件到达，停止定时器并通知等待者 */
+static inline void _slab_private_timed_event_on_alloc(void *ctx, event_t *e)
+{
+    slab_timed_alloc_event_t *te = (slab_timed_alloc_event_t *)ctx;
+
+    el_timer_stop(&te->timer);
+    te->notify_cb(te->notify_ctx, e);
+}
+
+/* Timer expires, remove the allocate event from the notify_q and notify the waiter */
+/* 定时器到期，将分配事件从notify_q中移除并通知等待者 */
+static inline void _slab_private_timed_event_on_timeout(void *ctx, event_t *e)
+{
+    slab_timed_alloc_event_t *te = (slab_timed_alloc_event_t *)ctx;
+
+    (void)e;
+
+    /* The memory block has been allocated, the allocate event will arrive soon */
+    /* 内存块已分配，分配事件即将到达 */
+    if (el_event_is_ready(&te->alloc_event.event)
+     || !fifo_del_node(&te->slab->notify_q, SLAB_ALLOC_EVENT_NODE(&te->alloc_event)))
+    {
+        return;
+    }
+
+    te->alloc_event.mem_blk = NULL;
+    _slab_private_stats_fail(te->slab);
+    te->notify_cb(te->notify_ctx, &te->alloc_event.event);
+}
+
+
+/************************************************************
+ *@brief:
+ ***slab timed allocate event initialization
+ *
+ *@parameter:
+ *[te]: the slab timed allocate event
+ *[callback]: callback of the waiter
+ *[ctx]: callback context of the waiter
+ *[priority]: priority of the event
+ *************************************************************/
+/************************************************************
+ *@简介：
+ ***带超时的slab分配事件初始化
+ *
+ *@参数：
+ *[te]：带超时的slab分配事件
+ *[callback]：等待者的回调函数
+ *[ctx]：等待者的回调上下文
+ *[priority]：事件的优先级
+ *************************************************************/
+static inline void slab_timed_alloc_event_init(slab_timed_alloc_event_t *te,
+                                               event_cb callback,
+                                               void *ctx,
+                                               uint8_t priority)
+{
+    slab_alloc_event_init(&te->alloc_event, _slab_private_timed_event_on_alloc, te, priority);
+    timer_init(&te->timer, _slab_private_timed_event_on_timeout, te, priority);
+    te->slab = NULL;
+    te->notify_cb = callback ? callback : EVENT_NULL_CB;
+    te->notify_ctx = ctx;
+}
+
+
+/************************************************************
+ *@brief:
+ ***slab timed allocate event inheritance initialization,
+ ***will inherit the parent event callback function,
+ ***context, priority
+ *
+ *@parameter:
+ *[te]: the slab timed allocate event
+ *[parent]: parent event
+ *************************************************************/
+/************************************************************
+ *@简介：
+ ***带超时的slab分配事件继承初始化，将继承父事件的回调函数，上下文，优先级
+ *
+ *@参数：
+ *[te]：带超时的slab分配事件
+ *[parent]：父事件
+ *************************************************************/
+static inline void slab_timed_alloc_event_init_inherit(slab_timed_alloc_event_t *te, const event_t *parent)
+{
+    slab_timed_alloc_event_init(te, parent->callback, parent->context, parent->priority);
+}
+
+
+/*********************************************
+ *@brief: wait for the slab allocator to have a memory block available with timeout.
+ ***The waiter is notified with &te->alloc_event.event when a memory block is
+ ***allocated or the wait is timeout, te->alloc_event.mem_blk is NULL on timeout.
+ *
+ *@contract: te was initialized by slab_timed_alloc_event_init(_inherit)
+ *
+ *@param:
+ *[slab] slab allocator
+ *[te] slab timed allocate event
+ *[timeout] millisecond timeout
+ *
+ *@return:
+ *[true] the slab allocator adds events successfully
+ *[false] events or the timer are in other queues and cannot be enqueue
+ *********************************************
+ */
+/*********************************************
+ *@简要：带超时地等待slab分配器有内存块可用。
+ ***分配到内存块或等待超时时都将以&te->alloc_event.event通知等待者，
+ ***超时时te->alloc_event.mem_blk为NULL
+ *
+ *@约定：te已由slab_timed_alloc_event_init(_inherit)初始化
+ *
+ *@参数：
+ *[slab] slab分配器
+ *[te] 带超时的slab分配事件
+ *[timeout] 毫秒超时时间
+ *
+ *@返回：
+ *[true] slab分配器添加事件成功
+ *[false] 事件或定时器处于其他队列中，不能入队
+ *********************************************
+ */
+static inline bool slab_wait_timeout(slab_t *slab, slab_timed_alloc_event_t *te, time_ms_t timeout)
+{
+    if (!slist_node_is_del(TIMER_NODE(&te->timer))
+     || !slab_wait(slab, &te->alloc_event))
+    {
+        return false;
+    }
+
+    te->slab = slab;
+
+    /* no memory block is available, start the timeout timer */
+    /* 没有可用的内存块，开启超时定时器 */
+    if (!el_event_is_ready(&te->alloc_event.event))
+    {
+        el_timer_start_ms(&te->timer, timeout);
+    }
+
+    return true;
+}
+
+
+/*********************************************
+ *@brief: Cancel the event of slab_wait_timeout
+ * 
+ *@param:
+ *[te] slab timed allocate event
+ *
+ *@return:
+ *[true] Cancel the slab allocator event successfully
+ *[false] Slab allocator event is not in the wait queue
+ *********************************************
+ */
+/*********************************************
+ *@简要：取消slab_wait_timeout的事件
+ * 
+ *@参数：
+ *[te] 带超时的slab分配事件
+ *
+ *@返回：
+ *[true] 取消slab分配器事件成功
+ *[false] slab分配器事件不处于等待队列中
+ *********************************************
+ */
+static inline bool slab_wait_timeout_cancel(slab_timed_alloc_event_t *te)
+{
+    el_timer_stop(&te->timer);
+
+    return te->slab != NULL && slab_wait_cancel(te->slab, &te->alloc_event);
+}
+
+#ifdef CONFIG_SLAB_STATS
+
+/*********************************************
+ *@brief: Get a snapshot of the slab statistics
+ * 
+ *@param:
+ *[slab] slab allocator
+ *[stats] output snapshot
+ *********************************************
+ */
+/*********************************************
+ *@简要：获取slab统计的快照
+ * 
+ *@参数：
+ *[slab] slab分配器
+ *[stats] 输出的快照
+ *********************************************
+ */
+static inline void slab_stats_get(slab_t *slab, slab_stats_t *stats)
+{
+    slist_node_t *node;
+
+    *stats = slab->stats;
+    stats->blk_nums = slab->blk_nums;
+    stats->nums_used = slab->nums_used;
+    stats->waiters = 0;
+
+    slist_foreach(FIFO_LIST(&slab->notify_q), node)
+    {
+        stats->waiters++;
+    }
+}
+
+
+/*********************************************
+ *@brief: Reset the slab statistics, the peak restarts from the current usage
+ * 
+ *@param:
+ *[slab] slab allocator
+ *********************************************
+ */
+/*********************************************
+ *@简要：重置slab统计，峰值从当前使用量重新开始
+ * 
+ *@参数：
+ *[slab] slab分配器
+ *********************************************
+ */
+static inline void slab_stats_reset(slab_t *slab)
+{
+    _slab_private_stats_clear(slab);
+}
+
+#endif /* CONFIG_SLAB_STATS */
+
+
+/*********************************************
+ *@brief: Check whether the memory block belongs to the slab
+ * 
+ *@param:
+ *[slab] slab allocator
+ *[mem] memory block
+ *
+ *@return:
+ *[true] the block is in the buffer of the slab
+ *[false] the block is not in the buffer of the slab
+ *********************************************
+ */
+/*********************************************
+ *@简要：检查内存块是否属于slab
+ * 
+ *@参数：
+ *[slab] slab分配器
+ *[mem] 内存块
+ *
+ *@返回：
+ *[true] 内存块处于slab的buffer中
+ *[false] 内存块不处于slab的buffer中
+ *********************************************
+ */
+static inline bool slab_contains(slab_t *slab, void *mem)
+{
+#ifdef CONFIG_SLAB_GROWABLE
+    slist_node_t *cur_node;
+
+    if (slab->provider)
+    {
+        slist_foreach(&slab->chunks, cur_node)
+        {
+            if ((uint8_t *)mem >= (uint8_t *)cur_node
+             && (uint8_t *)mem < (uint8_t *)cur_node + slab->chunk_size)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+#endif
+
+    return (uint8_t *)mem >= slab->buff
+        && (uint8_t *)mem < slab->buff + (size_t)slab->blk_nums * slab->blk_size;
+}
+
+
+/* slab cache definition, a family of size classes backed by slab_t */
+/* slab缓存定义，由slab_t支持的一组大小类 */
+typedef struct slab_cache_s
+{
+    /* slabs of size classes, sorted by block size in ascending order */
+    /* 大小类的slab，按块大小升序排列 */
+    slab_t      *classes;
+
+    /* number of size classes */
+    /* 大小类的个数 */
+    uint32_t    class_nums;
+} slab_cache_t;
+
+
+/*********************************************
+ *@brief: Initialize the slab cache with initialized slabs
+ * 
+ *@contract:
+ ***1. the slabs are sorted by block size in ascending order
+ ***2. the buffers of the slabs do not overlap
+ *
+ *@param:
+ *[cache] slab cache
+ *[slabs] initialized slabs of size classes
+ *[class_nums] number of size classes
+ *********************************************
+ */
+/*********************************************
+ *@简要：使用已初始化的slab初始化slab缓存
+ * 
+ *@约定：
+ ***1、slab按块大小升序排列
+ ***2、slab的buffer互不重叠
+ *
+ *@参数：
+ *[cache] slab缓存
+ *[slabs] 已初始化的大小类slab
+ *[class_nums] 大小类的个数
+ *********************************************
+ */
+static inline void slab_cache_init(slab_cache_t *cache, slab_t *slabs, uint32_t class_nums)
+{
+    cache->classes = slabs;
+    cache->class_nums = class_nums;
+}
+
+
+/*********************************************
+ *@brief: Initialize the slab cache with power-of-two size classes,
+ ***the buffer is divided in proportion to the block sizes,
+ ***so that every class has the same number of blocks,
+ ***the remainder goes to the largest class
+ * 
+ *@contract:
+ ***1. buf_size holds at least one block of every class,
+ ***i.e. not less than min_blk_size * (2 ^ class_nums - 1) plus alignment
+ *
+ *@param:
+ *[cache] slab cache
+ *[slabs] slabs of size classes, class_nums elements
+ *[class_nums] number of size classes
+ *[buff] memory pool buffer
+ *[buf_size] size of the buffer
+ *[min_blk_size] block size of the smallest class,
+ ***each next class doubles the block size
+ *********************************************
+ */
+/*********************************************
+ *@简要：以2的幂次大小类初始化slab缓存，buffer按块大小比例分配，
+ ***使每个大小类的块数相同，余下部分归最大的大小类
+ * 
+ *@约定：
+ ***1、buf_size至少容纳每个大小类的一个块，
+ ***即不小于min_blk_size * (2 ^ class_nums - 1)再加上对齐
+ *
+ *@参数：
+ *[cache] slab缓存
+ *[slabs] 大小类的slab，共class_nums个
+ *[class_nums] 大小类的个数
+ *[buff] 内存池buffer
+ *[buf_size] buffer的大小
+ *[min_blk_size] 最小大小类的块大小，之后每个大小类的块大小翻倍
+ *********************************************
+ */
+static inline void slab_cache_init_pow2(slab_cache_t *cache, slab_t *slabs, uint32_t class_nums,
+                                        void *buff, uint32_t buf_size, uint32_t min_blk_size)
+{
+    uint8_t *align_buff = (uint8_t *)ALIGN_UP((size_t)buff);
+    uint32_t size = (uint32_t)ALIGN_DOWN((uint8_t *)buff + buf_size - align_buff);
+    uint32_t strides = 0;
+    uint32_t blk_nums;
+    uint32_t class_size;
+    uint32_t i;
+
+    /* the size of one block of every class */
+    /* 每个大小类各一个块的大小 */
+    for (i = 0; i < class_nums; i++)
+    {
+        strides += (uint32_t)ALIGN_UP(min_blk_size << i);
+    }
+
+    blk_nums = size / strides;
+
+    for (i = 0; i < class_nums; i++)
+    {
+        class_size = (i + 1 < class_nums) ? blk_nums * (uint32_t)ALIGN_UP(min_blk_size << i) : size;
+        slab_init(&slabs[i], align_buff, class_size, min_blk_size << i);
+        align_buff += class_size;
+        size -= class_size;
+    }
+
+    slab_cache_init(cache, slabs, class_nums);
+}
+
+
+/*********************************************
+ *@brief: Get the smallest size class that fits the size
+ * 
+ *@param:
+ *[cache] slab cache
+ *[size] memory size
+ *
+ *@return: the slab of the size class, NULL if the size is too large
+ *********************************************
+ */
+/*********************************************
+ *@简要：获取能容纳size的最小大小类
+ * 
+ *@参数：
+ *[cache] slab缓存
+ *[size] 内存大小
+ *
+ *@返回：大小类的slab，size过大时为NULL
+ *********************************************
+ */
+static inline slab_t *slab_cache_class_get(slab_cache_t *cache, size_t size)
+{
+    uint32_t i;
+
+    for (i = 0; i < cache->class_nums; i++)
+    {
+        if (size <= cache->classes[i].blk_size)
+        {
+            return &cache->classes[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+/*********************************************
+ *@brief: Get the size class of the memory block by its address
+ * 
+ *@param:
+ *[cache] slab cache
+ *[mem] memory block allocated from the cache
+ *
+ *@return: the slab of the size class, NULL if the block does not belong to the cache
+ *********************************************
+ */
+/*********************************************
+ *@简要：按地址获取内存块所属的大小类
+ * 
+ *@参数：
+ *[cache] slab缓存
+ *[mem] 从缓存分配的内存块
+ *
+ *@返回：大小类的slab，内存块不属于缓存时为NULL
+ *********************************************
+ */
+static inline slab_t *slab_cache_slab_of(slab_cache_t *cache, void *mem)
+{
+    uint32_t i;
+
+    for (i = 0; i < cache->class_nums; i++)
+    {
+        if (slab_contains(&cache->classes[i], mem))
+        {
+            return &cache->classes[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+/*********************************************
+ *@brief: Allocate a block of at least size bytes,
+ ***from the smallest fitting size class,
+ ***falling back to larger classes when it is exhausted
+ * 
+ *@param:
+ *[cache] slab cache
+ *[size] memory size
+ *
+ *@return: memory block, NULL if no class can satisfy the size
+ *********************************************
+ */
+/*********************************************
+ *@简要：分配至少size字节的内存块，优先从最小的合适大小类分配，
+ ***该大小类耗尽时回退到更大的大小类
+ * 
+ *@参数：
+ *[cache] slab缓存
+ *[size] 内存大小
+ *
+ *@返回：内存块，没有大小类能满足时为NULL
+ *********************************************
+ */
+static inline void *slab_cache_alloc(slab_cache_t *cache, size_t size)
+{
+    slab_t *slab = slab_cache_class_get(cache, size);
+    slab_t *end = cache->classes + cache->class_nums;
+    void *mem;
+
+    for (; slab && slab < end; slab++)
+    {
+        mem = slab_alloc(slab);
+        if (mem)
+        {
+            return mem;
+        }
+    }
+
+    return NULL;
+}
+
+
+/*********************************************
+ *@brief: Free the memory block to its size class,
+ ***the class is looked up from the address
+ * 
+ *@param:
+ *[cache] slab cache
+ *[mem] memory block allocated from the cache
+ *********************************************
+ */
+/*********************************************
+ *@简要：释放内存块到其大小类，大小类由地址查找
+ * 
+ *@参数：
+ *[cache] slab缓存
+ *[mem] 从缓存分配的内存块
+ *********************************************
+ */
+static inline void slab_cache_free(slab_cache_t *cache, void *mem)
+{
+    slab_t *slab = slab_cache_slab_of(cache, mem);
+
+    if (slab)
+    {
+        slab_free(slab, mem);
+    }
+}
+
+
+/*********************************************
+ *@brief: Wait for a block of at least size bytes,
+ ***the event waits on the smallest fitting size class with slab_wait
+ * 
+ *@param:
+ *[cache] slab cache
+ *[size] memory size
+ *[alloc_event] slab allocate event
+ *
+ *@return:
+ *[true] Join the wait queue successfully
+ *[false] No class can satisfy the size, or the event is in use
+ *********************************************
+ */
+/*********************************************
+ *@简要：等待至少size字节的内存块，事件通过slab_wait在最小的合适大小类上等待
+ * 
+ *@参数：
+ *[cache] slab缓存
+ *[size] 内存大小
+ *[alloc_event] slab分配事件
+ *
+ *@返回：
+ *[true] 加入等待队列成功
+ *[false] 没有大小类能满足，或事件正在使用中
+ *********************************************
+ */
+static inline bool slab_cache_wait(slab_cache_t *cache, size_t size, slab_alloc_event_t *alloc_event)
+{
+    slab_t *slab = slab_cache_class_get(cache, size);
+
+    return slab != NULL && slab_wait(slab, alloc_event);
+}
+
+
+/*********************************************
+ *@brief: Cancel the event of slab_cache_wait
+ * 
+ *@param:
+ *[cache] slab cache
+ *[size] memory size used in slab_cache_wait
+ *[alloc_event] slab allocate event
+ *
+ *@return:
+ *[true] Cancel the slab allocator event successfully
+ *[false] Slab allocator event is not in the wait queue
+ *********************************************
+ */
+/*********************************************
+ *@简要：取消slab_cache_wait的事件
+ * 
+ *@参数：
+ *[cache] slab缓存
+ *[size] slab_cache_wait中使用的内存大小
+ *[alloc_event] slab分配事件
+ *
+ *@返回：
+ *[true] 取消slab分配器事件成功
+ *[false] slab分配器事件不处于等待队列中
+ *********************************************
+ */
+static inline bool slab_cache_wait_cancel(slab_cache_t *cache, size_t size, slab_alloc_event_t *alloc_event)
+{
+    slab_t *slab = slab_cache_class_get(cache, size);
+
+    return slab != NULL && slab_wait_cancel(slab, alloc_event);
+}
+
+
+#ifndef TASK_ASSERT
+#define TASK_ASSERT(expr)
+#endif /* TASK_ASSERT */
+
+#ifndef TASK_INFO
+#define TASK_INFO(task, stack_size, stack_used)
+#endif /* TASK_INFO */
+
+/*********************************************************
+ *@type description:
+ *
+ *[struct task_cur_ctx_s]：task current context information
+ *[struct task_stack_s]：task current stack pointer information
+ *[task_t]：task data structure
+ *[task_pool_t]：task pool, tasks with stacks of the same size allocated from a slab
+ *********************************************************
+ *@类型说明：
+ *
+ *[struct task_cur_ctx_s]：task当前的上下文信息
+ *[struct task_stack_s]：task当前栈指针信息
+ *[task_t]：task数据结构
+ *[task_pool_t]：任务池，从slab中分配的栈大小相同的任务
+ *********************************************************/
+struct task_cur_ctx_s
+{
+    uint8_t yield_state;
+    uint8_t bp;
+    uint16_t stack_used;
+};
+
+struct task_stack_s
+{
+    uint8_t *start;
+    uint8_t *end;
+    uint8_t *cur;
+};
+
+typedef struct task_s
+{
+    event_t event;
+    struct task_stack_s stack;
+    struct task_cur_ctx_s cur_ctx;
+    union 
+    {
+        void *ptr;
+        uint32_t u32;
+        int32_t  s32;
+    } ret_val;
+    lifo_t task_end_notify_q;
+#ifdef CONFIG_TASK_CANCEL
+    lifo_t cancel_q;
+    uint8_t cancelled;
+#endif /* CONFIG_TASK_CANCEL */
+    struct task_pool_s *pool;
+#ifdef CONFIG_TASK_STACKFUL
+    void *sf_sp;
+    void *sf_caller_sp;
+    event_t *sf_ev;
+#endif /* CONFIG_TASK_STACKFUL */
+#ifdef CONFIG_TASK_STACK_PROFILE
+    uint32_t stack_peak;
+#endif /* CONFIG_TASK_STACK_PROFILE */
+#ifdef CONFIG_TASK_SEGMENTED_STACK
+    slab_t *seg_slab;
+    struct task_stack_seg_s *seg;
+#endif /* CONFIG_TASK_SEGMENTED_STACK */
+} task_t;
+
+typedef struct task_pool_s
+{
+    slab_t slab;
+    uint32_t stack_size;
+    uint8_t priority;
+#ifdef CONFIG_TASK_SEGMENTED_STACK
+    slab_t *seg_slab;
+#endif /* CONFIG_TASK_SEGMENTED_STACK */
+} task_pool_t;
+
+
+/*********************************************************
+ *@type description:
+ *
+ *[task_asyn_routine_t]: task function and asynchronous function type
+ *********************************************************
+ *@类型说明：
+ *
+ *[task_asyn_routine_t]：任务函数与异步函数类型
+ *********************************************************/
+typedef void (*task_asyn_routine_t)(struct task_s *, event_t *);
+
+
+/* TASK bpd pointer, Used by bpd coroutine */
+/* TASK的bpd指针，由bpd协程使用 */
+#define TASK_BPD(task)  (&((task_t *)(task))->cur_ctx.bp)
+
+#ifdef CONFIG_TASK_SEGMENTED_STACK
+
+/*********************************************************
+ *@type description:
+ *
+ *[task_stack_seg_t]: stack segment header, at the start of a block of the segment slab
+ *[prev]: previous segment, NULL for the stack given to task_init
+ *[stack]: stack of the task before this segment was linked
+ *********************************************************
+ *@类型说明：
+ *
+ *[task_stack_seg_t]：栈段头，位于栈段slab块的起始处
+ *[prev]：上一个栈段，task_init给出的栈为NULL
+ *[stack]：链接此栈段前任务的栈
+ *********************************************************/
+typedef struct task_stack_seg_s
+{
+    struct task_stack_seg_s *prev;
+    struct task_stack_s stack;
+} task_stack_seg_t;
+
+#endif /* CONFIG_TASK_SEGMENTED_STACK */
+
+#ifdef CONFIG_TASK_STACK_PROFILE
+
+/* Number of asynchronous functions recorded by the stack profiler */
+/* 栈分析记录的异步函数个数 */
+#ifndef CONFIG_TASK_STACK_PROFILE_FUNCS
+#define CONFIG_TASK_STACK_PROFILE_FUNCS         64
+#endif /* CONFIG_TASK_STACK_PROFILE_FUNCS */
+
+/* Bucket width in bytes of the stack peak histogram */
+/* 栈峰值直方图的桶宽度（字节） */
+#ifndef CONFIG_TASK_STACK_PROFILE_BUCKET_SIZE
+#define CONFIG_TASK_STACK_PROFILE_BUCKET_SIZE   32
+#endif /* CONFIG_TASK_STACK_PROFILE_BUCKET_SIZE */
+
+/* Number of buckets of the stack peak histogram, the last bucket counts the rest */
+/* 栈峰值直方图的桶数，最后一个桶统计其余的峰值 */
+#ifndef CONFIG_TASK_STACK_PROFILE_BUCKETS
+#define CONFIG_TASK_STACK_PROFILE_BUCKETS       256
+#endif /* CONFIG_TASK_STACK_PROFILE_BUCKETS */
+
+/*********************************************************
+ *@type description:
+ *
+ *[task_stack_func_prof_t]: stack profile of an asynchronous function
+ *[task_stack_profile_t]: stack profile of all the tasks
+ *********************************************************
+ *@类型说明：
+ *
+ *[task_stack_func_prof_t]：异步函数的栈分析
+ *[task_stack_profile_t]：全部任务的栈分析
+ *********************************************************/
+typedef struct task_stack_func_prof_s
+{
+    /* function address, NULL for an empty entry */
+    /* 函数地址，空条目为NULL */
+    event_cb func;
+
+    /* number of calls */
+    /* 调用次数 */
+    uint32_t calls;
+
+    /* peak size of the asynchronous variables */
+    /* 异步变量大小的峰值 */
+    uint32_t vars_peak;
+
+    /* peak stack depth of the task on entry to the function,
+     * including the callers and the asynchronous variables of the function,
+     * not the functions it calls, their entries record their own depth */
+    /* 进入该函数时任务栈深度的峰值，包括调用者与该函数的异步变量，
+     * 不包括其调用的函数，被调用函数的条目记录各自的深度 */
+    uint32_t entry_depth_peak;
+} task_stack_func_prof_t;
+
+typedef struct task_stack_profile_s
+{
+    /* asynchronous functions, open addressing by address */
+    /* 异步函数，按地址开放寻址 */
+    task_stack_func_prof_t funcs[CONFIG_TASK_STACK_PROFILE_FUNCS];
+
+    /* functions not recorded because the table is full */
+    /* 因表满而未记录的函数调用 */
+    uint32_t funcs_dropped;
+
+    /* peak stack usage of all the tasks */
+    /* 全部任务的栈使用峰值 */
+    uint32_t peak;
+
+    /* number of the ended tasks in the histogram */
+    /* 直方图中已结束任务的个数 */
+    uint32_t task_nums;
+
+    /* histogram of the stack peaks of the ended tasks */
+    /* 已结束任务栈峰值的直方图 */
+    uint32_t hist[CONFIG_TASK_STACK_PROFILE_BUCKETS];
+} task_stack_profile_t;
+
+#define task_stack_profile EL_MACRO_CONCAT(task_stack_profile_m_, CONFIG_EL_MOUDLE_ID)
+/* stack profile object, defined in atask.c */
+/* 栈分析对象，定义于atask.c */
+extern task_stack_profile_t task_stack_profile;
+
+/* Stack depth of the task up to pos in the current segment,
+ * the used part of the previous segments is included */
+/* 任务栈在当前栈段中到pos为止的深度，包括之前栈段已使用的部分 */
+static inline uint32_t _task_private_stack_depth(task_t *task, uint8_t *pos)
+{
+    size_t depth = (size_t)(pos - task->stack.start);
+#ifdef CONFIG_TASK_SEGMENTED_STACK
+    struct task_stack_seg_s *seg;
+
+    for (seg = task->seg; seg != NULL; seg = seg->prev)
+    {
+        depth += (size_t)(seg->stack.cur - seg->stack.start);
+    }
+#endif /* CONFIG_TASK_SEGMENTED_STACK */
+
+    return (uint32_t)depth;
+}
+
+/* Reset the peak of the task */
+/* 重置任务的峰值 */
+static inline void _task_private_stack_profile_init(task_t *task)
+{
+    task->stack_peak = 0;
+}
+
+/* Record the stack usage of the task */
+/* 记录任务的栈使用量 */
+static inline void _task_private_stack_profile_used(task_t *task, uint32_t used)
+{
+    if (used > task->stack_peak)
+    {
+        task->stack_peak = used;
+        if (used > task_stack_profile.peak)
+        {
+            task_stack_profile.peak = used;
+        }
+    }
+}
+
+/* Record the asynchronous variables of the current function */
+/* 记录当前函数的异步变量 */
+static inline void _task_private_stack_profile_vars(task_t *task, size_t vars_size)
+{
+    event_cb func = EVENT_CALLBACK(&task->event);
+    uint32_t used = _task_private_stack_depth(task, task->stack.cur + vars_size);
+    uint32_t i = (uint32_t)(((size_t)func >> 4) % CONFIG_TASK_STACK_PROFILE_FUNCS);
+    uint32_t n;
+    task_stack_func_prof_t *prof;
+
+    _task_private_stack_profile_used(task, used);
+
+    for (n = 0; n < CONFIG_TASK_STACK_PROFILE_FUNCS; n++)
+    {
+        prof = &task_stack_profile.funcs[i];
+        if (prof->func == func || prof->func == NULL)
+        {
+            prof->func = func;
+            prof->calls++;
+            if (vars_size > prof->vars_peak)
+            {
+                prof->vars_peak = (uint32_t)vars_size;
+            }
+            if (used > prof->entry_depth_peak)
+            {
+                prof->entry_depth_peak = used;
+            }
+
+            return;
+        }
+
+        i = (i + 1) % CONFIG_TASK_STACK_PROFILE_FUNCS;
+    }
+
+    task_stack_profile.funcs_dropped++;
+}
+
+/* Add the peak of the ended task into the histogram */
+/* 将结束任务的峰值加入直方图 */
+static inline void _task_private_stack_profile_end(task_t *task)
+{
+    uint32_t bucket = task->stack_peak / CONFIG_TASK_STACK_PROFILE_BUCKET_SIZE;
+
+    if (bucket >= CONFIG_TASK_STACK_PROFILE_BUCKETS)
+    {
+        bucket = CONFIG_TASK_STACK_PROFILE_BUCKETS - 1;
+    }
+
+    task_stack_profile.hist[bucket]++;
+    task_stack_profile.task_nums++;
+    task->stack_peak = 0;
+}
+
+#else
+
+#define _task_private_stack_profile_init(task)
+#define _task_private_stack_profile_used(task, used)
+#define _task_private_stack_profile_vars(task, vars_size)
+#define _task_private_stack_profile_end(task)
+
+#endif /* CONFIG_TASK_STACK_PROFILE */
+
+#ifdef CONFIG_TASK_CANCEL
+
+struct task_cancel_reg_s;
+
+/*********************************************************
+ *@type description:
+ *
+ *[task_cancel_cb]: withdraws the registered wait, called by task_cancel
+ *********************************************************
+ *@类型说明：
+ *
+ *[task_cancel_cb]：撤销登记的等待，由task_cancel调用
+ *********************************************************/
+typedef void (*task_cancel_cb)(struct task_cancel_reg_s *reg);
+
+/*********************************************************
+ *@type description:
+ *
+ *[task_cancel_reg_t]: cancel registration, lives in the asynchronous variables
+ ***of the registering function and is dropped when the function returns
+ *[cancel]: withdraws the wait
+ *[obj]: the waiting object: timer, event or allocate event
+ *[arg]: the waited object: semaphore, slab, condition variable or future, or user argument
+ *********************************************************
+ *@类型说明：
+ *
+ *[task_cancel_reg_t]：取消登记，位于登记函数的异步变量中，函数返回时被丢弃
+ *[cancel]：撤销等待
+ *[obj]：等待的对象：定时器、事件或分配事件
+ *[arg]：被等待的对象：信号量、slab、条件变量或future，或用户参数
+ *********************************************************/
+typedef struct task_cancel_reg_s
+{
+    slist_node_t node;
+    task_cancel_cb cancel;
+    void *obj;
+    void *arg;
+} task_cancel_reg_t;
+
+#define TASK_CANCEL_REG_OF_NODE(node_ptr)   slist_entry(task_cancel_reg_t, node, node_ptr)
+
+/* Not cancelled and nothing registered */
+/* 未取消且没有登记 */
+static inline void _task_private_cancel_init(task_t *task)
+{
+    lifo_init(&task->cancel_q);
+    task->cancelled = 0;
+}
+
+/* Drop the registrations in the asynchronous variables of the returning function */
+/* 丢弃返回函数的异步变量中的登记 */
+static inline void _task_private_cancel_drop(task_t *task)
+{
+    while (!lifo_is_empty(&task->cancel_q))
+    {
+        uint8_t *reg = (uint8_t *)TASK_CANCEL_REG_OF_NODE(LIFO_TOP(&task->cancel_q));
+
+        if (reg < task->stack.cur || reg >= task->stack.cur + task->cur_ctx.stack_used)
+        {
+            break;
+        }
+
+        lifo_pop(&task->cancel_q);
+    }
+}
+
+#define _TASK_PRIVATE_CANCEL_STATIC_INIT(task)  LIFO_STATIC_INIT((task).cancel_q), 0,
+
+#else
+
+#define _task_private_cancel_init(task)
+#define _task_private_cancel_drop(task)
+#define _TASK_PRIVATE_CANCEL_STATIC_INIT(task)
+
+#endif /* CONFIG_TASK_CANCEL */
+
+#ifdef CONFIG_TASK_STACKFUL
+
+/* Not a stackful task until task_stackful_start */
+/* 在task_stackful_start之前不是有栈任务 */
+static inline void _task_private_stackful_init(task_t *task)
+{
+    task->sf_sp = NULL;
+}
+
+#else
+
+#define _task_private_stackful_init(task)
+
+#endif /* CONFIG_TASK_STACKFUL */
+
+
+/************************************************************
+ *@brief:
+ ***Task data structure static initialization
+ *
+ *@parameter:
+ *[task]: Task variable name, non-pointer
+ *[task_func]: Task function
+ *[stack]：Task stack
+ *[stack_size]：Stack size
+ *[priority]：Priority of task events
+ *************************************************************/
+/************************************************************
+ *@简介：
+ ***任务数据结构静态初始化
+ *
+ *@参数：
+ *[task]：任务的变量名，非指针
+ *[task_func]：任务函数
+ *[stack]：任务的栈
+ *[stack_size]：栈的大小
+ *[priority]：任务事件的优先级
+ *************************************************************/
+#define TASK_STATIC_INIT(task, stack, stack_size, priority)                     \
+{                                                                               \
+    EVENT_STATIC_INIT((task).event, (event_cb)NULL_CB, &task, (priority)),      \
+    {                                                                           \
+        (stack),                                                                \
+        (uint8_t *)(stack) + (stack_size),                                      \
+        (stack),                                                                \
+    },                                                                          \
+    {0, 0, BP_INIT_VAL},                                                        \
+    {0},                                                                        \
+    LIFO_STATIC_INIT((task).task_end_notify_q),                                 \
+    _TASK_PRIVATE_CANCEL_STATIC_INIT(task)                                      \
+    NULL                                                                        \
+}
+
+
+/************************************************************
+ *@brief:
+ ***Define a task object, and initialize
+ *
+ *@parameter:
+ *[_name]：The name of the task object
+ *[task_func]：Task function
+ *[stack_size]：Stack size
+ *[priority]：Priority of task events
+ *************************************************************/
+/************************************************************
+ *@简介：
+ ***定义一个任务对象，并初始化
+ *
+ *@参数：
+ *[_name]：任务对象的名字
+ *[task_func]：任务函数
+ *[stack_size]：任务栈的大小
+ *[priority]：任务事件的优先级
+ *************************************************************/
+#define TASK_DEFINE(_name, stack_size, priority)                    \
+    uint32_t _name##_stack_buf[(stack_size + 3) / 4];               \
+    task_t  _name = TASK_STATIC_INIT(_name,                         \
+                                     _name##_stack_buf,             \
+                                     (stack_size),                  \
+                                     (priority))
+
+
+/************************************************************
+ *@brief:
+ ***Define a task object using static modifiers, and initialize
+ *
+ *@parameter:
+ *[_name]：The name of the task object
+ *[task_func]：Task function
+ *[stack_size]：Stack size
+ *[priority]：Priority of task events
+ *************************************************************/
+/************************************************************
+ *@简介：
+ ***使用static修饰定义一个任务对象，并初始化
+ *
+ *@参数：
+ *[_name]：任务对象的名字
+ *[task_func]：任务函数
+ *[stack_size]：任务栈的大小
+ *[priority]：任务事件的优先级
+ *************************************************************/
+#define TASK_DEFINE_STATIC(_name, stack_size, priority)             \
+    static uint32_t _name##_stack_buf[(stack_size + 3) / 4];        \
+    static task_t  _name = TASK_STATIC_INIT(_name,                  \
+                                            _name##_stack_buf,      \
+                                            (stack_size),           \
+                                            (priority))
+
+/* The size of task context information to be saved when making an asynchronous call */
+/* 进行异步调用时需要保存的任务上下文信息大小 */
+#define TASK_STACK_CTX_SIZE (sizeof(struct task_cur_ctx_s) + sizeof(event_cb))
+
+/* yield_state of a function called by task_bpd_leaf_call whose caller context is not saved yet */
+/* 由task_bpd_leaf_call调用、调用者上下文尚未保存的函数的yield_state */
+#define TASK_YIELD_STATE_LEAF   2
+
+/* Simple macro, return a - b to ensure greater than or equal to 0 */
+/* 简单的宏，返回a - b保证大于等于0 */
+#define _SUB_BEZ(a, b)  ((a) > (b) ? ((a) - (b)) : 0)
+
+#ifdef CONFIG_TASK_SEGMENTED_STACK
+
+/* Task without stack segments */
+/* 没有栈段的任务 */
+static inline void _task_private_stack_seg_init(task_t *task)
+{
+    task->seg_slab = NULL;
+    task->seg = NULL;
+}
+
+/* Link a new stack segment with at least size bytes, return false when unavailable */
+/* 链接至少size字节的新栈段，不可用时返回false */
+static inline bool _task_private_stack_seg_push(task_t *task, size_t size)
+{
+    task_stack_seg_t *seg;
+
+    if (task->seg_slab == NULL
+        || ALIGN_UP(sizeof(task_stack_seg_t)) + size > slab_blk_size_get(task->seg_slab))
+    {
+        return false;
+    }
+
+    seg = (task_stack_seg_t *)slab_alloc(task->seg_slab);
+
+    if (seg == NULL)
+    {
+        return false;
+    }
+
+    seg->prev = task->seg;
+    seg->stack = task->stack;
+    task->seg = seg;
+    task->stack.start = (uint8_t *)seg + ALIGN_UP(sizeof(task_stack_seg_t));
+    task->stack.end = (uint8_t *)seg + slab_blk_size_get(task->seg_slab);
+    task->stack.cur = task->stack.start;
+
+    return true;
+}
+
+/*
+ * Unwind the segments left empty by the returning function.
+ * A segment always starts with the asynchronous variables of a callee,
+ * so the context frame saved by task_asyn_call_prepare stays in the
+ * segment of its caller and task_bpd_asyn_call can still compare it.
+ */
+/*
+ * 回退返回函数留下的空栈段。
+ * 栈段总是以被调用者的异步变量开始，task_asyn_call_prepare保存的
+ * 上下文留在调用者的栈段中，task_bpd_asyn_call仍可对其进行比较
+ */
+static inline void _task_private_stack_seg_unwind(task_t *task)
+{
+    while (task->seg != NULL && task->stack.cur == task->stack.start)
+    {
+        task_stack_seg_t *seg = task->seg;
+
+        task->stack = seg->stack;
+        task->seg = seg->prev;
+        slab_free(task->seg_slab, seg);
+    }
+}
+
+/* Keep room for size bytes and the context of a nested call, linking a segment if needed */
+/* 为size字节与嵌套调用的上下文保留空间，需要时链接栈段 */
+static inline void _task_private_stack_seg_reserve(task_t *task, size_t size)
+{
+    if (task->stack.cur + size + TASK_STACK_CTX_SIZE > task->stack.end)
+    {
+        _task_private_stack_seg_push(task, size + TASK_STACK_CTX_SIZE);
+    }
+}
+
+#else
+
+#define _task_private_stack_seg_init(task)
+#define _task_private_stack_seg_unwind(task)
+#define _task_private_stack_seg_reserve(task, size)
+
+#endif /* CONFIG_TASK_SEGMENTED_STACK */
+
+
+/************************************************************
+ *@brief:
+ ***Task data structure dynamic initialization,
+ ***if the task has been statically initialized, 
+ ***you don't have to use this function.
+ *
+ *@parameter:
+ *[task]: Task variable name, non-pointer
+ *[task_func]: Task function
+ *[stack]：Task stack
+ *[stack_size]：Stack size
+ *[priority]：Priority of task events
+ *************************************************************/
+/************************************************************
+ *@简介：
+ ***任务数据结构动态初始化，若task已静态初始化，则不必使用该函数
+ *
+ *@参数：
+ *[task]：任务的变量名，非指针
+ *[task_func]：任务函数
+ *[stack]：任务的栈
+ *[stack_size]：栈的大小
+ *[priority]：任务事件的优先级
+ *************************************************************/
+static inline void task_init(task_t *task, void *stack, size_t stack_size, uint8_t priority)
+{
+    event_init(&task->event, (event_cb)NULL_CB, task, priority);
+
+    task->stack.start = (uint8_t *)ALIGN_UP((size_t)stack);
+    task->stack.end = task->stack.start + _SUB_BEZ(stack_size, (size_t)(task->stack.start - (uint8_t *)stack));
+    task->stack.cur = task->stack.start;
+
+    task->ret_val.ptr = NULL;
+
+    task->cur_ctx.stack_used = 0;
+    task->cur_ctx.bp = BP_INIT_VAL;
+    task->cur_ctx.yield_state = 0;
+    lifo_init(&task->task_end_notify_q);
+    task->pool = NULL;
+    _task_private_stack_profile_init(task);
+    _task_private_stack_seg_init(task);
+    _task_private_cancel_init(task);
+    _task_private_stackful_init(task);
+}
+
+
+/************************************************************
+ *@brief:
+ ***start task
+ *
+ *@parameter:
+ *[task]: Task object, cannot be empty
+ *************************************************************/
+/************************************************************
+ *@简介：
+ ***启动任务
+ *
+ *@参数：
+ *[task]：任务对象，不能为空
+ *[task_func]: 任务函数，任务函数应该被声明为 void task_func(task_t *task, event_t *ev, 参数1, 参数2..)格式
+ *[...]: 任务函数的第3个及之后的参数
+ *************************************************************/
+#define task_start(task, task_func, ...)                        \
+    do {                                                        \
+        EVENT_CALLBACK(&(task)->event) = (event_cb)(task_func); \
+        (task_func)((task), NULL, ##__VA_ARGS__);               \
+    } while (0)
+
+
+/*********************************************************
+ *@type description:
+ *
+ *[task_spawn_args_t]: task function and arguments of a deferred start,
+ ***kept at the bottom of the task stack until the task runs
+ *[func]: task function
+ *[args]: arguments of the task function
+ *********************************************************
+ *@类型说明：
+ *
+ *[task_spawn_args_t]：延迟启动的任务函数及其参数，
+ ***在任务运行前保存于任务栈底
+ *[func]：任务函数
+ *[args]：任务函数的参数
+ *********************************************************/
+#define TASK_SPAWN_ARGS_MAX     6
+
+typedef void (*task_spawn_routine_t)(struct task_s *, event_t *,
+                                        uintptr_t, uintptr_t, uintptr_t,
+                                        uintptr_t, uintptr_t, uintptr_t);
+
+typedef struct task_spawn_args_s
+{
+    task_spawn_routine_t func;
+    uintptr_t args[TASK_SPAWN_ARGS_MAX];
+} task_spawn_args_t;
+
+#define _task_private_spawn_args0()     { 0 }
+#define _task_private_spawn_args1(a1)   { (uintptr_t)(a1) }
+#define _task_private_spawn_args2(a1, a2)                                   \
+    { (uintptr_t)(a1), (uintptr_t)(a2) }
+#define _task_private_spawn_args3(a1, a2, a3)                               \
+    { (uintptr_t)(a1), (uintptr_t)(a2), (uintptr_t)(a3) }
+#define _task_private_spawn_args4(a1, a2, a3, a4)                           \
+    { (uintptr_t)(a1), (uintptr_t)(a2), (uintptr_t)(a3), (uintptr_t)(a4) }
+#define _task_private_spawn_args5(a1, a2, a3, a4, a5)                       \
+    { (uintptr_t)(a1), (uintptr_t)(a2), (uintptr_t)(a3), (uintptr_t)(a4),   \
+      (uintptr_t)(a5) }
+#define _task_private_spawn_args6(a1, a2, a3, a4, a5, a6)                   \
+    { (uintptr_t)(a1), (uintptr_t)(a2), (uintptr_t)(a3), (uintptr_t)(a4),   \
+      (uintptr_t)(a5), (uintptr_t)(a6) }
+
+/* Entry of a deferred task, unpack the arguments and run the task function */
+/* 延迟启动任务的入口，取出参数并运行任务函数 */
+static inline void _task_private_spawn_entry(task_t *task, event_t *ev)
+{
+    /* the task function allocates its variables over the arguments, copy them first */
+    /* 任务函数的异步变量将覆盖参数，先将其拷贝出来 */
+    task_spawn_args_t spawn = *(task_spawn_args_t *)task->stack.start;
+
+    (void)ev;
+
+    /* cast through void (*)(void), the generic function pointer type */
+    /* 经由通用函数指针类型void (*)(void)转换 */
+    EVENT_CALLBACK(&task->event) = (event_cb)(void (*)(void))spawn.func;
+    spawn.func(task, NULL,
+                spawn.args[0], spawn.args[1], spawn.args[2],
+                spawn.args[3], spawn.args[4], spawn.args[5]);
+}
+
+/* Store the task function and arguments in the task stack and post the task event */
+/* 将任务函数及参数保存于任务栈中，并提交任务事件 */
+static inline void _task_private_start_deferred(task_t *task, const task_spawn_args_t *spawn)
+{
+    TASK_ASSERT(task->stack.cur == task->stack.start);
+    TASK_ASSERT((size_t)(task->stack.end - task->stack.start) >= sizeof(task_spawn_args_t));
+
+    *(task_spawn_args_t *)task->stack.start = *spawn;
+    EVENT_CALLBACK(&task->event) = (event_cb)_task_private_spawn_entry;
+    el_event_post(&task->event);
+}
+
+
+/************************************************************
+ *@brief:
+ ***Start the task on the next scheduling pass of the event loop
+ ***at the priority of the task, the caller continues immediately.
+ ***The arguments are stored in the task stack until the task runs.
+ *
+ *@contract:
+ ***1. At most TASK_SPAWN_ARGS_MAX arguments, each an integer or a pointer
+ ***no wider than a pointer (no floating point or structure arguments).
+ ***Every argument is converted to uintptr_t and passed as uintptr_t,
+ ***64-bit integer arguments are truncated on 32-bit targets
+ ***2. The task is not running and its stack holds at least sizeof(task_spawn_args_t)
+ *
+ *@parameter:
+ *[task]: task object, cannot be empty
+ *[task_func]: task function, declared as void task_func(task_t *task, event_t *ev, arg1, arg2..)
+ *[...]: the third and later arguments of the task function
+ *************************************************************/
+/************************************************************
+ *@简介：
+ ***在事件循环的下一次调度中以任务的优先级启动任务，调用者立即继续运行。
+ ***参数在任务运行前保存于任务栈中
+ *
+ *@约定：
+ ***1、最多TASK_SPAWN_ARGS_MAX个参数，每个参数为不超过指针宽度的整数或指针
+ ***（不能为浮点数或结构体）。
+ ***每个参数均被转换为uintptr_t并以uintptr_t传递，
+ ***在32位目标上64位整数参数将被截断
+ ***2、任务未在运行，且其栈至少可容纳sizeof(task_spawn_args_t)
+ *
+ *@参数：
+ *[task]：任务对象，不能为空
+ *[task_func]：任务函数，任务函数应该被声明为 void task_func(task_t *task, event_t *ev, 参数1, 参数2..)格式
+ *[...]：任务函数的第3个及之后的参数
+ *************************************************************/
+#define task_start_deferred(task, task_func, ...)                                   \
+    do {                                                                            \
+        task_spawn_args_t _task_spawn = {                                           \
+            (task_spawn_routine_t)(void (*)(void))(task_func),                      \
+            VA_ARGS_FUNC(_task_private_spawn_args, ##__VA_ARGS__) };                \
+        _task_private_start_deferred((task), &_task_spawn);                         \
+    } while (0)
+
+/*********************************************************
+ *@brief: 
+ ***Get the asynchronous variables in the current task stack.
+ ***
+ ***task will generate the operation of allocating memory 
+ ***when it is called for the first time. 
+ ***After bpd_yield causes bp to not be 0,
+ ***get again, return to the previous memory
+ *
+ *@contract: 
+ ***Cannot use null pointer
+ *
+ *@parameter:
+ *[task]: task object
+ *[vars_size]: The size of the asynchronous variables
+ *
+ *@return: Memory address of an asynchronous variables
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***获取当前task堆栈中的异步变量
+ ***
+ ***task在首次调用时，将产生分配内存的操作，
+ ***bpd_yield导致bp不为0后，再次获取，则返回以前的内存
+ *
+ *@约定：
+ ***不能使用空指针
+ *
+ *@参数：
+ *[task]：任务对象
+ *[vars_size]：异步变量的大小
+ *
+ *@返回：异步变量的内存地址
+ **********************************************************/
+static inline void *task_asyn_vars_get(task_t *task, size_t vars_size)
+{
+    if (task->cur_ctx.bp == BP_INIT_VAL)
+    {
+        size_t alloc_size = ALIGN_UP(vars_size);
+
+        _task_private_stack_seg_reserve(task, alloc_size);
+        TASK_INFO((task), (task->stack.end - task->stack.start), (task->stack.cur + alloc_size - task->stack.start));
+        TASK_ASSERT(task->stack.cur + alloc_size <= task->stack.end);
+        _task_private_stack_profile_vars(task, alloc_size);
+
+        task->cur_ctx.stack_used = alloc_size;
+    }
+
+    return task->stack.cur;
+}
+
+
+/*********************************************************
+ *@brief: 
+ ***The function called asynchronously returns to the caller
+ ***
+ ***Any function called by task_bpd_asyn_call should use this method to return to the caller
+ *
+ *@contract: 
+ ***Cannot use null pointer
+ *
+ *@parameter:
+ *[task]: task object
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***被异步调用的函数返回到调用者
+ ***
+ ***任何由task_bpd_asyn_call调用的函数，应当使用此方法返回到调用者
+ *
+ *@约定：
+ ***不能使用空指针
+ *
+ *@参数：
+ *[task]：任务对象
+ **********************************************************/
+static inline void task_asyn_return(task_t *task)
+{
+    _task_private_cancel_drop(task);
+    _task_private_stack_seg_unwind(task);
+
+    if (task->cur_ctx.yield_state == TASK_YIELD_STATE_LEAF)
+    {
+        /* A leaf call completed synchronously, the caller restores its own context */
+        /* 叶调用同步完成，由调用者恢复自身的上下文 */
+        task->stack.cur -= TASK_STACK_CTX_SIZE;
+    }
+    else if (task->stack.cur >= task->stack.start + TASK_STACK_CTX_SIZE)
+    {
+        /* Restore caller context information and event callbacks */
+        /* 恢复调用者上下文信息及事件回调 */
+        task->stack.cur -= TASK_STACK_CTX_SIZE;
+        task->cur_ctx = *(struct task_cur_ctx_s *)task->stack.cur;
+        EVENT_CALLBACK(&task->event) = *(event_cb *)(task->stack.cur + sizeof(struct task_cur_ctx_s));
+        task->stack.cur -= task->cur_ctx.stack_used;
+
+        TASK_ASSERT(task->stack.cur >= task->stack.start && task->stack.cur <= task->stack.end);
+
+        if (task->cur_ctx.yield_state == 1)
+        {
+            /* The caller is resumed once, a later synchronous call must not resume it again */
+            /* 调用者只恢复一次，之后的同步调用不能再次恢复它 */
+            task->cur_ctx.yield_state = 0;
+
+            /* Immediate return to the caller */
+            /* 立即返回调用者 */
+            el_event_sync_post(&task->event);
+        }
+    }
+    /* task end */
+    /* 任务结束 */
+    else
+    {
+        task->stack.cur = task->stack.start;
+        task->ret_val.ptr = NULL;
+        task->cur_ctx.stack_used = 0;
+        task->cur_ctx.bp = BP_INIT_VAL;
+        task->cur_ctx.yield_state = 0;
+        EVENT_CALLBACK(&(task)->event) = (event_cb)NULL_CB;
+        _task_private_stack_profile_end(task);
+        _task_private_cancel_init(task);
+
+        while (!lifo_is_empty(&task->task_end_notify_q))
+        {
+            /* Asynchronous post events can avoid errors caused by freeing task in callbacks */
+            /* 异步提交事件可避免在回调中释放task而引起错误 */
+            el_event_post(EVENT_OF_NODE(lifo_pop(&task->task_end_notify_q)));
+        }
+
+        /* The task of a task pool returns to its pool, the memory stays valid until it is allocated again */
+        /* 任务池的任务归还到所属的任务池，内存在被再次分配前保持有效 */
+        if (task->pool)
+        {
+            slab_free(&task->pool->slab, task);
+        }
+    }
+}
+
+
+/*********************************************************
+ *@brief: 
+ ***Determine if the coroutine task is end
+ *
+ *@return:
+ *[true]: task is end
+ *[false]: task not end
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***判断协程任务是否结束
+ *
+ *@返回：
+ *[true]：任务已结束
+ *[false]: 任务未结束
+ **********************************************************/
+static inline bool task_is_end(task_t *task)
+{
+    return EVENT_CALLBACK(&(task)->event) == (event_cb)NULL_CB;
+}
+
+
+/*********************************************************
+ *@brief: 
+ ***Add a listen event for the end action of the coroutine task,
+ ***and trigger the listen event when the coroutine task ends.
+ *
+ *@contract: 
+ ***The task_asyn_return must be called at 
+ ***the end of the topmost coroutine (started by task_start)
+ *
+ *@parameter:
+ *[task]: task object
+ *[task_end_notify_ev]: Event for listening to coroutine exit
+ *
+ *@return:
+ *[true]: Add a listen event successfully
+ *[false]: Listening events are in the reference state or in the queue
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***为协程任务的结束动作添加一个监听事件，协程任务结束时将触发
+ ***监听的事件
+ *
+ *@约定：
+ ***1、最上层的协程(由task_start启动)结束时必须调用task_asyn_return
+ *
+ *@参数：
+ *[task]：任务对象
+ *[task_end_notify_ev]：用于监听协程退出的事件
+ *
+ *@返回值：
+ *[true]：添加监听事件成功
+ *[false]：监听事件处于引用状态或者队列中
+ **********************************************************/
+static inline bool task_end_wait(task_t *task, event_t *task_end_notify_ev)
+{
+    if (!slist_node_is_del(EVENT_NODE(task_end_notify_ev)))
+    {
+        return false;
+    }
+
+    lifo_push(&task->task_end_notify_q, EVENT_NODE(task_end_notify_ev));
+
+    return true;
+}
+
+
+/*********************************************************
+ *@brief: 
+ ***Cancel the event listener for task_end_wait
+ *
+ *@parameter:
+ *[task]: task object
+ *[task_end_notify_ev]: The event used by task_end_wait
+ *
+ *@return:
+ *[true]: Cancel the listen event successfully
+ *[false]: The listened event is no in the listen queue
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***取消task_end_wait的事件监听
+ *
+ *@参数：
+ *[task]：任务对象
+ *[task_end_notify_ev]：传入task_end_wait的事件
+ *
+ *@返回值：
+ *[true]：取消监听事件成功
+ *[false]：监听的事件已经不在监听队列之中
+ **********************************************************/
+static inline bool task_end_wait_cancel(task_t *task, event_t *task_end_notify_ev)
+{
+    if (slist_node_is_del(EVENT_NODE(task_end_notify_ev)))
+    {
+        return false;
+    }
+
+    if (el_event_is_ready(task_end_notify_ev))
+    {
+        return el_event_cancel(task_end_notify_ev);
+    }
+    else
+    {
+        return lifo_del_node(&task->task_end_notify_q, EVENT_NODE(task_end_notify_ev));
+    }
+}
+
+
+/* Size of a block of the task pool: the task followed by its stack */
+/* 任务池中块的大小：任务及紧随其后的栈 */
+#define TASK_POOL_BLK_SIZE(stack_size)  (ALIGN_UP(sizeof(task_t)) + ALIGN_UP(stack_size))
+
+/* Size of the buffer for task_pool_init to hold nums tasks */
+/* task_pool_init容纳nums个任务所需的buffer大小 */
+#define TASK_POOL_BUFF_SIZE(stack_size, nums)   (TASK_POOL_BLK_SIZE(stack_size) * (nums) + sizeof(void *))
+
+
+/*********************************************************
+ *@brief: 
+ ***Initialize a task pool on a buffer, each task of the pool has a stack of stack_size.
+ ***The task of the pool returns to the pool automatically when it ends,
+ ***the recently returned task is allocated first to keep its stack warm in cache.
+ *
+ *@parameter:
+ *[pool]: task pool
+ *[buff]: buffer, TASK_POOL_BUFF_SIZE can be used to calculate its size
+ *[buf_size]: buffer size
+ *[stack_size]: stack size of each task
+ *[priority]: priority of the tasks
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***在buffer上初始化任务池，池中每个任务的栈大小为stack_size。
+ ***池中的任务结束时自动归还到任务池，
+ ***最近归还的任务优先被分配，使其栈仍在缓存中
+ *
+ *@参数：
+ *[pool]：任务池
+ *[buff]：buffer，可使用TASK_POOL_BUFF_SIZE计算其大小
+ *[buf_size]：buffer大小
+ *[stack_size]：每个任务的栈大小
+ *[priority]：任务的优先级
+ **********************************************************/
+static inline void task_pool_init(task_pool_t *pool, void *buff, uint32_t buf_size, uint32_t stack_size, uint8_t priority)
+{
+    slab_init_lazy(&pool->slab, buff, buf_size, (uint32_t)TASK_POOL_BLK_SIZE(stack_size));
+    pool->stack_size = (uint32_t)ALIGN_UP(stack_size);
+    pool->priority = priority;
+#ifdef CONFIG_TASK_SEGMENTED_STACK
+    pool->seg_slab = NULL;
+#endif /* CONFIG_TASK_SEGMENTED_STACK */
+}
+
+#ifdef CONFIG_SLAB_GROWABLE
+
+/*********************************************************
+ *@brief: 
+ ***Initialize a task pool on a growable slab, see slab_init_growable
+ *
+ *@parameter:
+ *[pool]: task pool
+ *[stack_size]: stack size of each task
+ *[chunk_size]: size of the chunk requested from the provider
+ *[provider]: page provider
+ *[release_delay_ms]: time of a chunk stays fully free before it is released
+ *[priority]: priority of the tasks
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***在可增长的slab上初始化任务池，参见slab_init_growable
+ *
+ *@参数：
+ *[pool]：任务池
+ *[stack_size]：每个任务的栈大小
+ *[chunk_size]：向页提供者申请的chunk大小
+ *[provider]：页提供者
+ *[release_delay_ms]：chunk被释放前需持续完全空闲的时间
+ *[priority]：任务的优先级
+ **********************************************************/
+static inline void task_pool_init_growable(task_pool_t *pool,
+                                           uint32_t stack_size,
+                                           uint32_t chunk_size,
+                                           const slab_page_provider_t *provider,
+                                           time_ms_t release_delay_ms,
+                                           uint8_t priority)
+{
+    slab_init_growable(&pool->slab, (uint32_t)TASK_POOL_BLK_SIZE(stack_size), chunk_size, provider, release_delay_ms);
+    pool->stack_size = (uint32_t)ALIGN_UP(stack_size);
+    pool->priority = priority;
+#ifdef CONFIG_TASK_SEGMENTED_STACK
+    pool->seg_slab = NULL;
+#endif /* CONFIG_TASK_SEGMENTED_STACK */
+}
+
+#endif /* CONFIG_SLAB_GROWABLE */
+
+/* Initialize the task in a block of the task pool */
+/* 初始化任务池块中的任务 */
+static inline task_t *_task_pool_private_task_init(task_pool_t *pool, void *mem)
+{
+    task_t *task = (task_t *)mem;
+
+    if (task != NULL)
+    {
+        task_init(task, (uint8_t *)task + ALIGN_UP(sizeof(task_t)), pool->stack_size, pool->priority);
+        task->pool = pool;
+#ifdef CONFIG_TASK_SEGMENTED_STACK
+        task->seg_slab = pool->seg_slab;
+#endif /* CONFIG_TASK_SEGMENTED_STACK */
+    }
+
+    return task;
+}
+
+
+/*********************************************************
+ *@brief: 
+ ***Allocate a task from the task pool, the task is returned to the pool when it ends
+ *
+ *@parameter:
+ *[pool]: task pool
+ *
+ *@return:
+ *[NULL]: the task pool is exhausted
+ *[other]: the task
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***从任务池分配一个任务，任务结束时归还到任务池
+ *
+ *@参数：
+ *[pool]：任务池
+ *
+ *@返回值：
+ *[NULL]：任务池已耗尽
+ *[其他]：任务
+ **********************************************************/
+static inline task_t *task_pool_alloc(task_pool_t *pool)
+{
+    return _task_pool_private_task_init(pool, slab_alloc(&pool->slab));
+}
+
+
+/*********************************************************
+ *@brief: 
+ ***Return a task that has not been started to the task pool
+ *
+ *@parameter:
+ *[pool]: task pool
+ *[task]: task allocated from the pool and not started
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***将未启动的任务归还到任务池
+ *
+ *@参数：
+ *[pool]：任务池
+ *[task]：从任务池分配且未启动的任务
+ **********************************************************/
+static inline void task_pool_free(task_pool_t *pool, task_t *task)
+{
+    slab_free(&pool->slab, task);
+}
+
+
+/*********************************************************
+ *@brief: 
+ ***Wait for a task of the task pool to be available,
+ ***get the task with task_pool_task_get after the event is triggered
+ *
+ *@parameter:
+ *[pool]: task pool
+ *[alloc_event]: slab allocate event
+ *
+ *@return:
+ *[true]: Start waiting successfully
+ *[false]: The allocate event is in the reference state or in the queue
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***等待任务池中的任务可用，事件触发后使用task_pool_task_get获取任务
+ *
+ *@参数：
+ *[pool]：任务池
+ *[alloc_event]：slab分配事件
+ *
+ *@返回值：
+ *[true]：开始等待成功
+ *[false]：分配事件处于引用状态或者队列中
+ **********************************************************/
+static inline bool task_pool_wait(task_pool_t *pool, slab_alloc_event_t *alloc_event)
+{
+    return slab_wait(&pool->slab, alloc_event);
+}
+
+
+/*********************************************************
+ *@brief: 
+ ***Wait for a task of the task pool to be available with timeout,
+ ***cancel it with slab_wait_timeout_cancel
+ *
+ *@parameter:
+ *[pool]: task pool
+ *[te]: slab timed allocate event
+ *[timeout]: timeout in milliseconds, task_pool_task_get returns NULL on timeout
+ *
+ *@return:
+ *[true]: Start waiting successfully
+ *[false]: The allocate event is in the reference state or in the queue
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***带超时地等待任务池中的任务可用，使用slab_wait_timeout_cancel取消
+ *
+ *@参数：
+ *[pool]：任务池
+ *[te]：带超时的slab分配事件
+ *[timeout]：超时毫秒数，超时时task_pool_task_get返回NULL
+ *
+ *@返回值：
+ *[true]：开始等待成功
+ *[false]：分配事件处于引用状态或者队列中
+ **********************************************************/
+static inline bool task_pool_wait_timeout(task_pool_t *pool, slab_timed_alloc_event_t *te, time_ms_t timeout)
+{
+    return slab_wait_timeout(&pool->slab, te, timeout);
+}
+
+
+/*********************************************************
+ *@brief: 
+ ***Cancel the waiting of task_pool_wait
+ *
+ *@parameter:
+ *[pool]: task pool
+ *[alloc_event]: slab allocate event
+ *
+ *@return:
+ *[true]: Cancel successfully
+ *[false]: The allocate event is not waiting
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***取消task_pool_wait的等待
+ *
+ *@参数：
+ *[pool]：任务池
+ *[alloc_event]：slab分配事件
+ *
+ *@返回值：
+ *[true]：取消成功
+ *[false]：分配事件不处于等待中
+ **********************************************************/
+static inline bool task_pool_wait_cancel(task_pool_t *pool, slab_alloc_event_t *alloc_event)
+{
+    return slab_wait_cancel(&pool->slab, alloc_event);
+}
+
+
+/*********************************************************
+ *@brief: 
+ ***Get the task allocated by the triggered allocate event
+ *
+ *@parameter:
+ *[pool]: task pool
+ *[alloc_event]: triggered slab allocate event
+ *
+ *@return:
+ *[NULL]: no task is allocated (timeout)
+ *[other]: the task
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***获取已触发的分配事件所分配的任务
+ *
+ *@参数：
+ *[pool]：任务池
+ *[alloc_event]：已触发的slab分配事件
+ *
+ *@返回值：
+ *[NULL]：没有分配到任务（超时）
+ *[其他]：任务
+ **********************************************************/
+static inline task_t *task_pool_task_get(task_pool_t *pool, slab_alloc_event_t *alloc_event)
+{
+    void *mem = alloc_event->mem_blk;
+
+    alloc_event->mem_blk = NULL;
+
+    return _task_pool_private_task_init(pool, mem);
+}
+
+
+/*********************************************************
+ *@brief: 
+ ***Allocate a task from the task pool and start it,
+ ***task is NULL if the task pool is exhausted
+ *
+ *@parameter:
+ *[pool]: task pool
+ *[task]: variable to receive the task
+ *[task_func]: task function
+ *[...]: task function parameters
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***从任务池分配一个任务并启动，任务池耗尽时task为NULL
+ *
+ *@参数：
+ *[pool]：任务池
+ *[task]：接收任务的变量
+ *[task_func]：任务函数
+ *[...]：任务函数参数
+ **********************************************************/
+#define task_pool_spawn(pool, task, task_func, ...)                 \
+    do {                                                            \
+        (task) = task_pool_alloc(pool);                             \
+        if ((task) != NULL)                                         \
+        {                                                           \
+            task_start((task), task_func, ##__VA_ARGS__);           \
+        }                                                           \
+    } while (0)
+
+
+/*********************************************************
+ *@brief: 
+ ***Allocate a task from the task pool and start it with task_start_deferred,
+ ***the task runs on the next scheduling pass, task is NULL if the task pool is exhausted
+ *
+ *@parameter:
+ *[pool]: task pool
+ *[task]: variable to receive the task
+ *[task_func]: task function
+ *[...]: task function parameters, see task_start_deferred
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***从任务池分配一个任务并使用task_start_deferred启动，
+ ***任务在下一次调度时运行，任务池耗尽时task为NULL
+ *
+ *@参数：
+ *[pool]：任务池
+ *[task]：接收任务的变量
+ *[task_func]：任务函数
+ *[...]：任务函数参数，见task_start_deferred
+ **********************************************************/
+#define task_pool_spawn_deferred(pool, task, task_func, ...)        \
+    do {                                                            \
+        (task) = task_pool_alloc(pool);                             \
+        if ((task) != NULL)                                         \
+        {                                                           \
+            task_start_deferred((task), task_func, ##__VA_ARGS__);  \
+        }                                                           \
+    } while (0)
+
+
+/*********************************************************
+ *@brief: 
+ ***Used in the bpd coroutine, allocate a task from the task pool and start it,
+ ***the coroutine yields until a task is available if the task pool is exhausted
+ *
+ *@contract: 
+ ***1. alloc_event is an asynchronous variable inherited from the event of the current task
+ ***2. task_func parameters must remain valid after yield (asynchronous variables)
+ *
+ *@parameter:
+ *[bp_num]: breakpoint number
+ *[pool]: task pool
+ *[task]: variable to receive the task
+ *[alloc_event]: slab allocate event
+ *[task_func]: task function
+ *[...]: task function parameters
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***在bpd协程中使用，从任务池分配一个任务并启动，
+ ***任务池耗尽时协程挂起，直到有任务可用
+ *
+ *@约定：
+ ***1、alloc_event为从当前任务的事件继承的异步变量
+ ***2、task_func的参数在挂起后须仍然有效（异步变量）
+ *
+ *@参数：
+ *[bp_num]：断点号
+ *[pool]：任务池
+ *[task]：接收任务的变量
+ *[alloc_event]：slab分配事件
+ *[task_func]：任务函数
+ *[...]：任务函数参数
+ **********************************************************/
+#define task_pool_bpd_spawn(bp_num, pool, task, alloc_event, task_func, ...)    \
+    do {                                                                        \
+        (task) = task_pool_alloc(pool);                                         \
+        if ((task) == NULL)                                                     \
+        {                                                                       \
+            task_pool_wait((pool), (alloc_event));                              \
+            bpd_yield(bp_num);                                                  \
+            (task) = task_pool_task_get((pool), (alloc_event));                 \
+        }                                                                       \
+        task_start((task), task_func, ##__VA_ARGS__);                           \
+    } while (0)
+
+
+/*********************************************************
+ *@type description:
+ *
+ *[task_hib_t]: compact block of a hibernated task,
+ ***the task and its live stack are kept in a block of a slab cache
+ ***while the stack block of the task returns to its task pool
+ *[wake]: event waited by the hibernated task, then used to wait for the task pool
+ *[cache]: slab cache of the compact block
+ *[task]: the task until its stack is saved, NULL after
+ *[callback]: event callback of the task at hibernation
+ *[stack_used]: live stack bytes, followed by the saved stack
+ *[pool_wait]: waiting for a block of the task pool
+ *[saved]: saved task
+ *********************************************************
+ *@类型说明：
+ *
+ *[task_hib_t]：休眠任务的紧凑块，任务及其在用的栈保存于slab缓存的块中，
+ ***而任务的栈块归还到其任务池
+ *[wake]：休眠任务等待的事件，之后用于等待任务池
+ *[cache]：紧凑块所属的slab缓存
+ *[task]：栈保存前为任务，之后为NULL
+ *[callback]：休眠时任务的事件回调
+ *[stack_used]：在用的栈字节数，保存的栈紧随其后
+ *[pool_wait]：正在等待任务池的块
+ *[saved]：保存的任务
+ *********************************************************/
+typedef struct task_hib_s
+{
+    slab_alloc_event_t wake;
+    slab_cache_t *cache;
+    task_t *task;
+    event_cb callback;
+    uint32_t stack_used;
+    uint8_t pool_wait;
+    task_t saved;
+} task_hib_t;
+
+/* Size of the compact block of a task hibernated with stack_used live stack bytes */
+/* 在用栈为stack_used字节的任务休眠时紧凑块的大小 */
+#define TASK_HIB_BLK_SIZE(stack_used)   (sizeof(task_hib_t) + ALIGN_UP(stack_used))
+
+/* Save the task and its live stack, and return its block to the task pool */
+/* 保存任务及其在用的栈，并将其块归还到任务池 */
+static inline void _task_private_hibernate_commit(task_hib_t *hib, event_t *ev)
+{
+    task_t *task = hib->task;
+    uint32_t stack_used = (uint32_t)(task->stack.cur + task->cur_ctx.stack_used - task->stack.start);
+
+    (void)ev;
+
+    TASK_ASSERT(stack_used <= hib->stack_used);
+
+    hib->stack_used = stack_used;
+    hib->saved = *task;
+    memcpy_spare(hib + 1, task->stack.start, hib->stack_used);
+
+    /* the queue heads are circular lists, move the nodes instead of the heads */
+    /* 队列头为循环链表，转移节点而非队列头 */
+    lifo_init(&hib->saved.task_end_notify_q);
+    lifo_nodes_transfer_to(&task->task_end_notify_q, &hib->saved.task_end_notify_q);
+    hib->task = NULL;
+
+    slab_free(&task->pool->slab, task);
+}
+
+/* The awaited event fired, restore the task into a block of its pool and resume it */
+/* 等待的事件已触发，将任务恢复到其任务池的块中并恢复运行 */
+static inline void _task_private_hibernate_wake(task_hib_t *hib, event_t *ev)
+{
+    task_pool_t *pool;
+    task_t *task;
+
+    (void)ev;
+
+    /* fired before the stack was saved */
+    /* 在栈保存之前触发 */
+    if (hib->task != NULL)
+    {
+        el_event_cancel(&hib->task->event);
+        _task_private_hibernate_commit(hib, NULL);
+    }
+
+    pool = hib->saved.pool;
+
+    if (hib->pool_wait)
+    {
+        task = (task_t *)hib->wake.mem_blk;
+    }
+    else
+    {
+        task = (task_t *)slab_alloc(&pool->slab);
+    }
+
+    if (task == NULL)
+    {
+        /* the task pool is exhausted, wait for a block */
+        /* 任务池已耗尽，等待可用的块 */
+        hib->pool_wait = 1;
+        slab_wait(&pool->slab, &hib->wake);
+        return;
+    }
+
+    *task = hib->saved;
+    event_init(&task->event, hib->callback, task, EVENT_PRIORITY(&hib->saved.event));
+    task->stack.start = (uint8_t *)task + ALIGN_UP(sizeof(task_t));
+    task->stack.end = task->stack.start + pool->stack_size;
+    task->stack.cur = task->stack.start + (hib->saved.stack.cur - hib->saved.stack.start);
+    memcpy_spare(task->stack.start, hib + 1, hib->stack_used);
+    lifo_init(&task->task_end_notify_q);
+    lifo_nodes_transfer_to(&hib->saved.task_end_notify_q, &task->task_end_notify_q);
+#ifdef CONFIG_TASK_CANCEL
+    lifo_init(&task->cancel_q);
+#endif /* CONFIG_TASK_CANCEL */
+
+    slab_cache_free(hib->cache, hib);
+
+    el_event_sync_post(&task->event);
+}
+
+
+/*********************************************************
+ *@brief: 
+ ***Hibernate a task of a task pool before a long wait.
+ ***The task and its live stack are moved to a right-sized block of the slab cache
+ ***and its block returns to the task pool once the task has yielded.
+ ***When the returned event fires, the task is restored into a block of its pool
+ ***(waiting for one if the pool is exhausted) and resumed with the task event.
+ ***A task that cannot hibernate returns its own event to wait as usual:
+ ***a task not from a task pool, the slab cache exhausted,
+ ***registrations of task_cancel_reg, a segment of the segmented stack in use
+ ***or a stackful task (its machine stack holds raw return addresses and pointers).
+ ***Usage:
+ ***    ev = task_hibernate(task, &cache);
+ ***    sem_take(&sem, ev);
+ ***    bpd_yield(3);
+ *
+ *@contract: 
+ ***1. Used by bp coroutines, the returned event is armed once and the coroutine yields at once
+ ***2. The task is restored at another address, while hibernated nothing may refer to
+ ***the task or its stack: events initialized from the task event before hibernation
+ ***are initialized again after the wake, pointers into the stack are computed again,
+ ***and task_cancel, task_end_wait and the like are not called on the old task
+ ***3. The returned event is a plain event, it can not be used with slab_wait
+ *
+ *@parameter:
+ *[task]: task of a task pool
+ *[cache]: slab cache of the compact blocks, see TASK_HIB_BLK_SIZE
+ *
+ *@return:
+ ***event to arm for the wait
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***在长时间等待前使任务池的任务休眠。
+ ***任务及其在用的栈移动到slab缓存中大小合适的块，任务挂起后其块归还到任务池。
+ ***返回的事件触发时，任务恢复到其任务池的块中（任务池耗尽时等待可用的块），
+ ***并以任务事件恢复运行。
+ ***不能休眠的任务返回其自身的事件，照常等待：不是来自任务池的任务、
+ ***slab缓存已耗尽、存在task_cancel_reg的注册、正在使用分段栈的栈段
+ ***或有栈任务（其机器栈保存着原始的返回地址和指针）。
+ ***用法：
+ ***    ev = task_hibernate(task, &cache);
+ ***    sem_take(&sem, ev);
+ ***    bpd_yield(3);
+ *
+ *@约定：
+ ***1、由bp协程使用，返回的事件设置一次，之后协程立即挂起
+ ***2、任务将恢复到其他地址，休眠期间不能有任何对任务或其栈的引用：
+ ***休眠前从任务事件初始化的事件在唤醒后须重新初始化，指向栈的指针须重新计算，
+ ***且不能对旧任务调用task_cancel、task_end_wait等
+ ***3、返回的事件为普通事件，不能用于slab_wait
+ *
+ *@参数：
+ *[task]：任务池的任务
+ *[cache]：紧凑块的slab缓存，见TASK_HIB_BLK_SIZE
+ *
+ *@返回：
+ ***需设置以等待的事件
+ **********************************************************/
+static inline event_t *task_hibernate(task_t *task, slab_cache_t *cache)
+{
+    size_t stack_used = task->stack.cur + task->cur_ctx.stack_used - task->stack.start;
+    task_hib_t *hib;
+
+    if (task->pool == NULL)
+    {
+        return &task->event;
+    }
+
+#ifdef CONFIG_TASK_CANCEL
+    if (!lifo_is_empty(&task->cancel_q))
+    {
+        return &task->event;
+    }
+#endif /* CONFIG_TASK_CANCEL */
+
+#ifdef CONFIG_TASK_SEGMENTED_STACK
+    if (task->seg != NULL)
+    {
+        return &task->event;
+    }
+#endif /* CONFIG_TASK_SEGMENTED_STACK */
+
+#ifdef CONFIG_TASK_STACKFUL
+    if (task->sf_sp != NULL)
+    {
+        return &task->event;
+    }
+#endif /* CONFIG_TASK_STACKFUL */
+
+    hib = (task_hib_t *)slab_cache_alloc(cache, TASK_HIB_BLK_SIZE(stack_used));
+    if (hib == NULL)
+    {
+        return &task->event;
+    }
+
+    slab_alloc_event_init(&hib->wake, (event_cb)_task_private_hibernate_wake, hib, EVENT_PRIORITY(&task->event));
+    hib->cache = cache;
+    hib->task = task;
+    hib->callback = EVENT_CALLBACK(&task->event);
+    hib->stack_used = (uint32_t)stack_used;
+    hib->pool_wait = 0;
+
+    /* The stack is saved on the next scheduling pass, after the coroutine
+       and its callers have yielded and written their contexts */
+    /* 栈在下一次调度时保存，此时协程及其调用者均已挂起并写入了上下文 */
+    EVENT_CONTEXT(&task->event) = hib;
+    EVENT_CALLBACK(&task->event) = (event_cb)_task_private_hibernate_commit;
+    el_event_post(&task->event);
+
+    return &hib->wake.event;
+}
+
+
+#ifdef CONFIG_TASK_STACK_PROFILE
+
+/*********************************************************
+ *@brief: 
+ ***Get the peak stack usage of the running task,
+ ***including the contexts saved by the asynchronous calls
+ *
+ *@parameter:
+ *[task]: task object
+ *
+ *@return value:
+ ***peak stack usage in bytes, reset when the task ends
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***获取运行中任务的栈使用峰值，包括异步调用保存的上下文
+ *
+ *@参数：
+ *[task]：任务对象
+ *
+ *@返回值：
+ ***栈使用峰值（字节），任务结束时重置
+ **********************************************************/
+static inline uint32_t task_stack_peak_get(task_t *task)
+{
+    return task->stack_peak;
+}
+
+
+/*********************************************************
+ *@brief: 
+ ***Get the peak stack usage of all the tasks, including the running ones
+ *
+ *@return value:
+ ***peak stack usage in bytes
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***获取全部任务的栈使用峰值，包括运行中的任务
+ *
+ *@返回值：
+ ***栈使用峰值（字节）
+ **********************************************************/
+static inline uint32_t task_stack_profile_max(void)
+{
+    return task_stack_profile.peak;
+}
+
+
+/*********************************************************
+ *@brief: 
+ ***Get the percentile of the stack peaks of the ended tasks,
+ ***the result is rounded up to the bucket width
+ *
+ *@parameter:
+ *[percent]: percentile, 0 ~ 100
+ *
+ *@return value:
+ ***stack usage in bytes, 0 if no task has ended
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***获取已结束任务栈峰值的百分位数，结果向上取整到桶宽度
+ *
+ *@参数：
+ *[percent]：百分位，0 ~ 100
+ *
+ *@返回值：
+ ***栈使用量（字节），没有已结束的任务时为0
+ **********************************************************/
+static inline uint32_t task_stack_profile_percentile(uint32_t percent)
+{
+    uint64_t rank = ((uint64_t)task_stack_profile.task_nums * percent + 99) / 100;
+    uint64_t count = 0;
+    uint32_t i;
+
+    if (task_stack_profile.task_nums == 0)
+    {
+        return 0;
+    }
+
+    for (i = 0; i < CONFIG_TASK_STACK_PROFILE_BUCKETS - 1; i++)
+    {
+        count += task_stack_profile.hist[i];
+        if (count >= rank && count > 0)
+        {
+            return (i + 1) * CONFIG_TASK_STACK_PROFILE_BUCKET_SIZE;
+        }
+    }
+
+    /* in the last bucket, only the maximum is known */
+    /* 位于最后一个桶，只知道最大值 */
+    return task_stack_profile.peak;
+}
+
+
+/*********************************************************
+ *@brief: 
+ ***Get the profile of an asynchronous function
+ *
+ *@parameter:
+ *[index]: 0 ~ CONFIG_TASK_STACK_PROFILE_FUNCS - 1
+ *
+ *@return value:
+ *[NULL]: the entry is empty
+ *[other]: profile of the function
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***获取异步函数的栈分析
+ *
+ *@参数：
+ *[index]：0 ~ CONFIG_TASK_STACK_PROFILE_FUNCS - 1
+ *
+ *@返回值：
+ *[NULL]：该条目为空
+ *[其他]：函数的栈分析
+ **********************************************************/
+static inline const task_stack_func_prof_t *task_stack_profile_func_get(uint32_t index)
+{
+    if (index >= CONFIG_TASK_STACK_PROFILE_FUNCS || task_stack_profile.funcs[index].func == NULL)
+    {
+        return NULL;
+    }
+
+    return &task_stack_profile.funcs[index];
+}
+
+
+/*********************************************************
+ *@brief: 
+ ***Reset the stack profile, the peaks of the running tasks are kept
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***重置栈分析，运行中任务的峰值保持不变
+ **********************************************************/
+static inline void task_stack_profile_reset(void)
+{
+    memset_spare(&task_stack_profile, 0, sizeof(task_stack_profile));
+}
+
+#endif /* CONFIG_TASK_STACK_PROFILE */
+
+#ifdef CONFIG_TASK_SEGMENTED_STACK
+
+/*********************************************************
+ *@brief: 
+ ***Set the slab from which the task links stack segments on overflow.
+ ***The block size of the slab is the size of a segment including its header,
+ ***the asynchronous variables of one function must fit in a segment.
+ *
+ *@contract: 
+ ***1. Set before the task starts or while it is not running in a segment
+ ***2. The slab must stay valid while the task uses segments
+ *
+ *@parameter:
+ *[task]: task object
+ *[seg_slab]: segment slab, NULL to disable segments for the task
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***设置任务栈溢出时链接栈段所用的slab。
+ ***slab的块大小即包括栈段头在内的栈段大小，
+ ***一个函数的异步变量必须能放入一个栈段
+ *
+ *@约定：
+ ***1、在任务启动前或任务未运行于栈段中时设置
+ ***2、任务使用栈段期间slab须保持有效
+ *
+ *@参数：
+ *[task]：任务对象
+ *[seg_slab]：栈段slab，为NULL则该任务不使用栈段
+ **********************************************************/
+static inline void task_stack_seg_slab_set(task_t *task, slab_t *seg_slab)
+{
+    task->seg_slab = seg_slab;
+}
+
+/*********************************************************
+ *@brief: 
+ ***Set the segment slab of the tasks allocated from the pool afterwards
+ *
+ *@parameter:
+ *[pool]: task pool
+ *[seg_slab]: segment slab, NULL to disable segments
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***设置此后从任务池分配的任务的栈段slab
+ *
+ *@参数：
+ *[pool]：任务池
+ *[seg_slab]：栈段slab，为NULL则不使用栈段
+ **********************************************************/
+static inline void task_pool_seg_slab_set(task_pool_t *pool, slab_t *seg_slab)
+{
+    pool->seg_slab = seg_slab;
+}
+
+#endif /* CONFIG_TASK_SEGMENTED_STACK */
+
+#ifdef CONFIG_TASK_CANCEL
+
+/*********************************************************
+ *@brief: 
+ ***Register a pending wait of the current asynchronous function with the task,
+ ***task_cancel calls cancel(reg) to withdraw it.
+ ***The registration is dropped when the registering function returns,
+ ***a wait that completes normally may stay registered.
+ *
+ *@contract: 
+ ***1. reg is in the asynchronous variables of the current function
+ ***2. register reg once per call, e.g. before the first bpd_yield
+ *
+ *@parameter:
+ *[task]: task object
+ *[reg]: cancel registration
+ *[cancel]: withdraws the wait
+ *[obj]: the waiting object
+ *[arg]: the waited object or user argument
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***向任务登记当前异步函数的一个挂起等待，
+ ***task_cancel调用cancel(reg)将其撤销。
+ ***登记在登记函数返回时被丢弃，正常完成的等待可以保持登记
+ *
+ *@约定：
+ ***1、reg位于当前函数的异步变量中
+ ***2、每次调用只登记一次reg，例如在首个bpd_yield之前
+ *
+ *@参数：
+ *[task]：任务对象
+ *[reg]：取消登记
+ *[cancel]：撤销等待
+ *[obj]：等待的对象
+ *[arg]：被等待的对象或用户参数
+ **********************************************************/
+static inline void task_cancel_reg(task_t *task, task_cancel_reg_t *reg, task_cancel_cb cancel, void *obj, void *arg)
+{
+    reg->cancel = cancel;
+    reg->obj = obj;
+    reg->arg = arg;
+    lifo_push(&task->cancel_q, &reg->node);
+}
+
+/*********************************************************
+ *@brief: 
+ ***Remove a registration before the registering function returns
+ *
+ *@parameter:
+ *[task]: task object
+ *[reg]: cancel registration
+ *
+ *@return:
+ *[true]: removed
+ *[false]: reg is not registered
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***在登记函数返回前移除登记
+ *
+ *@参数：
+ *[task]：任务对象
+ *[reg]：取消登记
+ *
+ *@返回：
+ *[true]：已移除
+ *[false]：reg未被登记
+ **********************************************************/
+static inline bool task_cancel_unreg(task_t *task, task_cancel_reg_t *reg)
+{
+    return lifo_del_node(&task->cancel_q, &reg->node);
+}
+
+/* Withdraw a timer */
+/* 撤销定时器 */
+static inline void _task_private_cancel_timer(task_cancel_reg_t *reg)
+{
+    el_timer_stop((timer_event_t *)reg->obj);
+}
+
+/* Withdraw an event from the event loop */
+/* 从事件循环撤销事件 */
+static inline void _task_private_cancel_event(task_cancel_reg_t *reg)
+{
+    el_event_cancel((event_t *)reg->obj);
+}
+
+/* Withdraw a semaphore take */
+/* 撤销信号量获取 */
+static inline void _task_private_cancel_sem(task_cancel_reg_t *reg)
+{
+    sem_take_cancel((sem_t *)reg->arg, (event_t *)reg->obj);
+}
+
+/* Withdraw a slab wait, a block already handed over returns to the slab */
+/* 撤销slab等待，已交付的块归还slab */
+static inline void _task_private_cancel_slab(task_cancel_reg_t *reg)
+{
+    slab_wait_cancel((slab_t *)reg->arg, (slab_alloc_event_t *)reg->obj);
+}
+
+/* Withdraw a condition variable wait */
+/* 撤销条件变量等待 */
+static inline void _task_private_cancel_acond(task_cancel_reg_t *reg)
+{
+    acond_wait_cancel((acond_t *)reg->arg, (event_t *)reg->obj);
+}
+
+/* Withdraw a future await */
+/* 撤销future等待 */
+static inline void _task_private_cancel_future(task_cancel_reg_t *reg)
+{
+    future_await_cancel((future_t *)reg->arg, (event_t *)reg->obj);
+}
+
+/*********************************************************
+ *@brief: 
+ ***Register a timer, see task_cancel_reg
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***登记定时器，参见task_cancel_reg
+ **********************************************************/
+static inline void task_cancel_reg_timer(task_t *task, task_cancel_reg_t *reg, timer_event_t *timer)
+{
+    task_cancel_reg(task, reg, _task_private_cancel_timer, timer, NULL);
+}
+
+/*********************************************************
+ *@brief: 
+ ***Register an event posted to the event loop, see task_cancel_reg
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***登记提交到事件循环的事件，参见task_cancel_reg
+ **********************************************************/
+static inline void task_cancel_reg_event(task_t *task, task_cancel_reg_t *reg, event_t *ev)
+{
+    task_cancel_reg(task, reg, _task_private_cancel_event, ev, NULL);
+}
+
+/*********************************************************
+ *@brief: 
+ ***Register a sem_take wait, see task_cancel_reg
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***登记sem_take等待，参见task_cancel_reg
+ **********************************************************/
+static inline void task_cancel_reg_sem(task_t *task, task_cancel_reg_t *reg, sem_t *sem, event_t *ev)
+{
+    task_cancel_reg(task, reg, _task_private_cancel_sem, ev, sem);
+}
+
+/*********************************************************
+ *@brief: 
+ ***Register a slab_wait, see task_cancel_reg
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***登记slab_wait等待，参见task_cancel_reg
+ **********************************************************/
+static inline void task_cancel_reg_slab(task_t *task, task_cancel_reg_t *reg, slab_t *slab, slab_alloc_event_t *alloc_event)
+{
+    task_cancel_reg(task, reg, _task_private_cancel_slab, alloc_event, slab);
+}
+
+/*********************************************************
+ *@brief: 
+ ***Register an acond_wait, see task_cancel_reg
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***登记acond_wait等待，参见task_cancel_reg
+ **********************************************************/
+static inline void task_cancel_reg_acond(task_t *task, task_cancel_reg_t *reg, acond_t *c, event_t *ev)
+{
+    task_cancel_reg(task, reg, _task_private_cancel_acond, ev, c);
+}
+
+/*********************************************************
+ *@brief: 
+ ***Register a future_await, see task_cancel_reg
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***登记future_await等待，参见task_cancel_reg
+ **********************************************************/
+static inline void task_cancel_reg_future(task_t *task, task_cancel_reg_t *reg, future_t *f, event_t *ev)
+{
+    task_cancel_reg(task, reg, _task_private_cancel_future, ev, f);
+}
+
+/*********************************************************
+ *@brief: 
+ ***Check whether the task has been cancelled
+ *
+ *@parameter:
+ *[task]: task object
+ *
+ *@return:
+ *[true]: cancelled, the task is unwinding
+ *[false]: not cancelled
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***检查任务是否已被取消
+ *
+ *@参数：
+ *[task]：任务对象
+ *
+ *@返回：
+ *[true]：已取消，任务正在逐层返回
+ *[false]：未取消
+ **********************************************************/
+static inline bool task_is_cancelled(task_t *task)
+{
+    return task->cancelled != 0;
+}
+
+/*********************************************************
+ *@brief: 
+ ***Cancel a running task from outside: withdraw all the registered waits
+ ***and resume the task at its current breakpoint with the cancelled status.
+ ***Each function checks task_is_cancelled (or task_bpd_cancel_check) after
+ ***resuming and returns with task_asyn_return, so the task unwinds and ends.
+ *
+ *@contract: 
+ ***1. Every wait the task may be suspended on is registered
+ ***2. Not called by the task itself
+ *
+ *@parameter:
+ *[task]: task object
+ *
+ *@return:
+ *[true]: the task is cancelled
+ *[false]: the task has ended or is already cancelled
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***从外部取消运行中的任务：撤销全部登记的等待，
+ ***并以已取消状态在当前断点恢复任务。
+ ***各函数恢复后检查task_is_cancelled（或task_bpd_cancel_check），
+ ***使用task_asyn_return返回，任务逐层返回并结束
+ *
+ *@约定：
+ ***1、任务可能挂起的每个等待均已登记
+ ***2、不能由任务自身调用
+ *
+ *@参数：
+ *[task]：任务对象
+ *
+ *@返回：
+ *[true]：任务已取消
+ *[false]：任务已结束或已被取消
+ **********************************************************/
+static inline bool task_cancel(task_t *task)
+{
+    if (task_is_end(task) || task->cancelled)
+    {
+        return false;
+    }
+
+    task->cancelled = 1;
+
+    while (!lifo_is_empty(&task->cancel_q))
+    {
+        task_cancel_reg_t *reg = TASK_CANCEL_REG_OF_NODE(lifo_pop(&task->cancel_q));
+
+        reg->cancel(reg);
+    }
+
+    /* Resume the task, it may already be in the event loop */
+    /* 恢复任务，任务可能已在事件循环中 */
+    el_event_post(&task->event);
+
+    return true;
+}
+
+/*********************************************************
+ *@brief: 
+ ***In a bpd coroutine, jump to bpd_end if the task has been cancelled,
+ ***used after each bpd_yield and task_bpd_asyn_call of cancellable code
+ *
+ *@parameter:
+ *[task]: task object
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***在bpd协程中，若任务已被取消则跳转到bpd_end，
+ ***用于可取消代码的每个bpd_yield与task_bpd_asyn_call之后
+ *
+ *@参数：
+ *[task]：任务对象
+ **********************************************************/
+#define task_bpd_cancel_check(task)         \
+    do {                                    \
+        if (task_is_cancelled(task))        \
+        {                                   \
+            bpd_break;                      \
+        }                                   \
+    } while (0)
+
+#endif /* CONFIG_TASK_CANCEL */
+
+
+/*********************************************************
+ *@type description:
+ *
+ *[task_nursery_child_t]: block of a nursery child: the end notify event, the task and its stack
+ *********************************************************
+ *@类型说明：
+ *
+ *[task_nursery_child_t]：nursery子任务的块：结束通知事件、任务及其栈
+ *********************************************************/
+typedef struct task_nursery_child_s
+{
+    event_t end_ev;
+    slist_node_t node;
+    struct task_nursery_s *nursery;
+    task_t task;
+} task_nursery_child_t;
+
+/*********************************************************
+ *@type description:
+ *
+ *[task_nursery_t]: scope of child tasks, opened in the asynchronous variables of the parent
+ *[slab]: slab of the child blocks
+ *[children]: running children
+ *[nums]: number of the children not yet ended
+ *[err]: first failure reported by task_nursery_child_fail, 0 if none
+ *[join_ev]: event posted when all children have ended
+ *[priority]: priority of the children
+ *********************************************************
+ *@类型说明：
+ *
+ *[task_nursery_t]：子任务的作用域，在父任务的异步变量中打开
+ *[slab]：子任务块的slab
+ *[children]：运行中的子任务
+ *[nums]：尚未结束的子任务数
+ *[err]：task_nursery_child_fail报告的首个失败，没有则为0
+ *[join_ev]：全部子任务结束时提交的事件
+ *[priority]：子任务的优先级
+ *********************************************************/
+typedef struct task_nursery_s
+{
+    slab_t *slab;
+    lifo_t children;
+    uint32_t nums;
+    int32_t err;
+    event_t *join_ev;
+    uint8_t priority;
+#ifdef CONFIG_TASK_CANCEL
+    task_cancel_reg_t cancel_reg;
+#endif /* CONFIG_TASK_CANCEL */
+} task_nursery_t;
+
+/* Size of a block of the nursery slab: the child followed by its stack */
+/* nursery的slab中块的大小：子任务及紧随其后的栈 */
+#define TASK_NURSERY_BLK_SIZE(stack_size)   (ALIGN_UP(sizeof(task_nursery_child_t)) + ALIGN_UP(stack_size))
+
+/* Size of the buffer of the nursery slab to hold nums children */
+/* nursery的slab容纳nums个子任务所需的buffer大小 */
+#define TASK_NURSERY_BUFF_SIZE(stack_size, nums)    (TASK_NURSERY_BLK_SIZE(stack_size) * (nums) + sizeof(void *))
+
+/* Nursery child containing the task */
+/* 包含该任务的nursery子任务 */
+#define TASK_NURSERY_CHILD_OF(task_ptr)     container_of(task_ptr, task_nursery_child_t, task)
+
+#ifdef CONFIG_TASK_CANCEL
+
+/* Cancel all the running children */
+/* 取消全部运行中的子任务 */
+static inline void _task_nursery_private_cancel(task_nursery_t *nursery, task_t *except)
+{
+    slist_node_t *node;
+
+    slist_foreach(&nursery->children.list, node)
+    {
+        task_t *task = &slist_entry(task_nursery_child_t, node, node)->task;
+
+        if (task != except)
+        {
+            task_cancel(task);
+        }
+    }
+}
+
+/* The parent is cancelled, cancel the children, the parent still joins them */
+/* 父任务被取消，取消子任务，父任务仍需等待它们结束 */
+static inline void _task_nursery_private_parent_cancel(task_cancel_reg_t *reg)
+{
+    _task_nursery_private_cancel((task_nursery_t *)reg->obj, NULL);
+}
+
+#endif /* CONFIG_TASK_CANCEL */
+
+/* A child has ended, return its block and wake the parent after the last one */
+/* 子任务已结束，归还其块，最后一个结束后唤醒父任务 */
+static inline void _task_nursery_private_child_end(task_nursery_child_t *child, event_t *ev)
+{
+    task_nursery_t *nursery = child->nursery;
+
+    (void)ev;
+
+    lifo_del_node(&nursery->children, &child->node);
+    slab_free(nursery->slab, child);
+
+    if (--nursery->nums == 0 && nursery->join_ev != NULL)
+    {
+        el_event_post(nursery->join_ev);
+        nursery->join_ev = NULL;
+    }
+}
+
+
+/*********************************************************
+ *@brief: 
+ ***Open a nursery in the asynchronous variables of the parent task.
+ ***The children and their stacks are drawn from slab, the stack size
+ ***of a child is the block size of slab minus the child header
+ ***(see TASK_NURSERY_BLK_SIZE). With CONFIG_TASK_CANCEL, cancelling
+ ***the parent cancels the children.
+ *
+ *@contract: 
+ ***1. nursery is an asynchronous variable of the current function of task
+ ***2. The function joins the nursery (task_bpd_nursery_join) before it returns
+ *
+ *@parameter:
+ *[nursery]: nursery
+ *[task]: parent task
+ *[slab]: slab of the child blocks
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***在父任务的异步变量中打开nursery。
+ ***子任务及其栈从slab中分配，子任务的栈大小为slab的块大小
+ ***减去子任务头（参见TASK_NURSERY_BLK_SIZE）。
+ ***定义CONFIG_TASK_CANCEL时，取消父任务将取消子任务
+ *
+ *@约定：
+ ***1、nursery是task当前函数的异步变量
+ ***2、函数返回前须等待nursery（task_bpd_nursery_join）
+ *
+ *@参数：
+ *[nursery]：nursery
+ *[task]：父任务
+ *[slab]：子任务块的slab
+ **********************************************************/
+static inline void task_nursery_init(task_nursery_t *nursery, task_t *task, slab_t *slab)
+{
+    nursery->slab = slab;
+    lifo_init(&nursery->children);
+    nursery->nums = 0;
+    nursery->err = 0;
+    nursery->join_ev = NULL;
+    nursery->priority = EVENT_PRIORITY(&task->event);
+#ifdef CONFIG_TASK_CANCEL
+    task_cancel_reg(task, &nursery->cancel_reg, _task_nursery_private_parent_cancel, nursery, NULL);
+#endif /* CONFIG_TASK_CANCEL */
+}
+
+/*********************************************************
+ *@brief: 
+ ***Allocate a child task of the nursery, start it with task_start
+ *
+ *@parameter:
+ *[nursery]: nursery
+ *
+ *@return:
+ *[NULL]: the slab is exhausted
+ *[other]: child task
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***分配nursery的子任务，使用task_start启动
+ *
+ *@参数：
+ *[nursery]：nursery
+ *
+ *@返回：
+ *[NULL]：slab已耗尽
+ *[其他]：子任务
+ **********************************************************/
+static inline task_t *task_nursery_alloc(task_nursery_t *nursery)
+{
+    task_nursery_child_t *child = (task_nursery_child_t *)slab_alloc(nursery->slab);
+    uint32_t blk_size = slab_blk_size_get(nursery->slab);
+
+    if (child == NULL)
+    {
+        return NULL;
+    }
+
+    task_init(&child->task,
+                (uint8_t *)child + ALIGN_UP(sizeof(task_nursery_child_t)),
+                blk_size - ALIGN_UP(sizeof(task_nursery_child_t)),
+                nursery->priority);
+    event_init(&child->end_ev, (event_cb)_task_nursery_private_child_end, child, nursery->priority);
+    child->nursery = nursery;
+    lifo_push(&nursery->children, &child->node);
+    nursery->nums++;
+    task_end_wait(&child->task, &child->end_ev);
+
+    return &child->task;
+}
+
+/*********************************************************
+ *@brief: 
+ ***Allocate a child task of the nursery and start it,
+ ***task is NULL if the slab is exhausted
+ *
+ *@parameter:
+ *[nursery]: nursery
+ *[task]: variable to receive the task
+ *[task_func]: task function
+ *[...]: task function parameters
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***分配nursery的子任务并启动，slab耗尽时task为NULL
+ *
+ *@参数：
+ *[nursery]：nursery
+ *[task]：接收任务的变量
+ *[task_func]：任务函数
+ *[...]：任务函数参数
+ **********************************************************/
+#define task_nursery_spawn(nursery, task, task_func, ...)           \
+    do {                                                            \
+        (task) = task_nursery_alloc(nursery);                       \
+        if ((task) != NULL)                                         \
+        {                                                           \
+            task_start((task), task_func, ##__VA_ARGS__);           \
+        }                                                           \
+    } while (0)
+
+/*********************************************************
+ *@brief: 
+ ***Report the failure of a child, called by the child before it returns.
+ ***The first failure is kept in the nursery, with CONFIG_TASK_CANCEL
+ ***it cancels the siblings.
+ *
+ *@parameter:
+ *[task]: child task of a nursery
+ *[err]: error code, not 0
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***报告子任务失败，由子任务在返回前调用。
+ ***首个失败保存于nursery中，定义CONFIG_TASK_CANCEL时取消其兄弟任务
+ *
+ *@参数：
+ *[task]：nursery的子任务
+ *[err]：错误码，非0
+ **********************************************************/
+static inline void task_nursery_child_fail(task_t *task, int32_t err)
+{
+    task_nursery_t *nursery = TASK_NURSERY_CHILD_OF(task)->nursery;
+
+    if (nursery->err == 0)
+    {
+        nursery->err = err;
+#ifdef CONFIG_TASK_CANCEL
+        _task_nursery_private_cancel(nursery, task);
+#endif /* CONFIG_TASK_CANCEL */
+    }
+}
+
+/*********************************************************
+ *@brief: 
+ ***Get the first failure of the nursery
+ *
+ *@parameter:
+ *[nursery]: nursery
+ *
+ *@return:
+ *[0]: no child failed
+ *[other]: error code of the first failure
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***获取nursery的首个失败
+ *
+ *@参数：
+ *[nursery]：nursery
+ *
+ *@返回：
+ *[0]：没有子任务失败
+ *[其他]：首个失败的错误码
+ **********************************************************/
+static inline int32_t task_nursery_err_get(task_nursery_t *nursery)
+{
+    return nursery->err;
+}
+
+/*********************************************************
+ *@brief: 
+ ***Wait for all the children of the nursery to end
+ *
+ *@parameter:
+ *[nursery]: nursery
+ *[join_ev]: event posted when the last child has ended
+ *
+ *@return:
+ *[true]: waiting, join_ev will be posted
+ *[false]: all the children have ended
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***等待nursery的全部子任务结束
+ *
+ *@参数：
+ *[nursery]：nursery
+ *[join_ev]：最后一个子任务结束时提交的事件
+ *
+ *@返回：
+ *[true]：等待中，join_ev将被提交
+ *[false]：全部子任务已结束
+ **********************************************************/
+static inline bool task_nursery_join(task_nursery_t *nursery, event_t *join_ev)
+{
+    if (nursery->nums == 0)
+    {
+        return false;
+    }
+
+    nursery->join_ev = join_ev;
+
+    return true;
+}
+
+/*********************************************************
+ *@brief: 
+ ***Used in the bpd coroutine, yield until all the children of the nursery
+ ***have ended, also when the parent is resumed early by task_cancel
+ *
+ *@parameter:
+ *[bp_num]: breakpoint number
+ *[task]: parent task
+ *[nursery]: nursery
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***在bpd协程中使用，挂起直到nursery的全部子任务结束，
+ ***父任务被task_cancel提前恢复时同样继续等待
+ *
+ *@参数：
+ *[bp_num]：断点号
+ *[task]：父任务
+ *[nursery]：nursery
+ **********************************************************/
+#define task_bpd_nursery_join(bp_num, task, nursery)                \
+    do {                                                            \
+        while (task_nursery_join((nursery), &(task)->event))        \
+        {                                                           \
+            bpd_yield(bp_num);                                      \
+        }                                                           \
+    } while (0)
+
+
+/* Generator states */
+/* 生成器状态 */
+#define GEN_STATE_RUNNING       0
+#define GEN_STATE_READY         1
+#define GEN_STATE_SUSPENDED     2
+#define GEN_STATE_DONE          3
+
+/*********************************************************
+ *@type description:
+ *
+ *[gen_t]: generator, a producer task that yields a stream of values to a consumer
+ *[task]: producer task
+ *[value]: last yielded value
+ *[out]: where the value is delivered to a waiting consumer
+ *[next_ev]: event of the waiting consumer, NULL if none
+ *[state]: GEN_STATE_xxx
+ *********************************************************
+ *@类型说明：
+ *
+ *[gen_t]：生成器，向消费者产出值流的生产者任务
+ *[task]：生产者任务
+ *[value]：最近产出的值
+ *[out]：交付给等待中消费者的位置
+ *[next_ev]：等待中消费者的事件，没有则为NULL
+ *[state]：GEN_STATE_xxx
+ *********************************************************/
+typedef struct gen_s
+{
+    task_t task;
+    void *value;
+    void **out;
+    event_t *next_ev;
+    uint8_t state;
+} gen_t;
+
+/* Generator of the producer task */
+/* 生产者任务所属的生成器 */
+#define GEN_OF_TASK(task_ptr)   container_of(task_ptr, gen_t, task)
+
+/* Hand a value to the consumer, directly if it is waiting */
+/* 将值交给消费者，消费者正在等待则直接交付 */
+static inline void _gen_private_put(gen_t *gen, void *value)
+{
+    gen->value = value;
+
+    if (gen->next_ev != NULL)
+    {
+        /* The producer resumed from the event loop, the consumer is resumed asynchronously
+           so that a long stream does not nest the two on the C stack */
+        /* 生产者由事件循环恢复，消费者被异步恢复，避免长的值流在C栈上嵌套两者 */
+        *gen->out = value;
+        gen->state = GEN_STATE_SUSPENDED;
+        el_event_post(gen->next_ev);
+        gen->next_ev = NULL;
+    }
+    else
+    {
+        gen->state = GEN_STATE_READY;
+    }
+}
+
+
+/*********************************************************
+ *@brief: 
+ ***Initialize a generator, its producer task runs on the given stack
+ *
+ *@parameter:
+ *[gen]: generator
+ *[stack]: stack of the producer task
+ *[stack_size]: stack size
+ *[priority]: priority of the producer task
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***初始化生成器，生产者任务运行于给定的栈上
+ *
+ *@参数：
+ *[gen]：生成器
+ *[stack]：生产者任务的栈
+ *[stack_size]：栈的大小
+ *[priority]：生产者任务的优先级
+ **********************************************************/
+static inline void gen_init(gen_t *gen, void *stack, size_t stack_size, uint8_t priority)
+{
+    task_init(&gen->task, stack, stack_size, priority);
+    gen->value = NULL;
+    gen->out = NULL;
+    gen->next_ev = NULL;
+    gen->state = GEN_STATE_DONE;
+}
+
+/*********************************************************
+ *@brief: 
+ ***Start the producer, it runs until its first value, its end or its first wait.
+ ***The producer is a task function that gets its generator with GEN_OF_TASK,
+ ***yields values with gen_bpd_yield and ends with gen_return.
+ *
+ *@parameter:
+ *[gen]: generator
+ *[task_func]: producer function
+ *[...]: producer function parameters
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***启动生产者，其运行到产出第一个值、结束或首次等待为止。
+ ***生产者是任务函数，使用GEN_OF_TASK获取其生成器，
+ ***使用gen_bpd_yield产出值，使用gen_return结束
+ *
+ *@参数：
+ *[gen]：生成器
+ *[task_func]：生产者函数
+ *[...]：生产者函数参数
+ **********************************************************/
+#define gen_start(gen, task_func, ...)                              \
+    do {                                                            \
+        (gen)->next_ev = NULL;                                      \
+        (gen)->state = GEN_STATE_RUNNING;                           \
+        task_start(&(gen)->task, task_func, ##__VA_ARGS__);         \
+    } while (0)
+
+/*********************************************************
+ *@brief: 
+ ***Used in the bpd coroutine of the producer, yield a value
+ ***and suspend until the consumer asks for the next one
+ *
+ *@parameter:
+ *[bp_num]: breakpoint number
+ *[gen]: generator
+ *[value]: value, a pointer or an integer cast to a pointer
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***在生产者的bpd协程中使用，产出一个值并挂起，直到消费者请求下一个值
+ *
+ *@参数：
+ *[bp_num]：断点号
+ *[gen]：生成器
+ *[value]：值，指针或转换为指针的整数
+ **********************************************************/
+#define gen_bpd_yield(bp_num, gen, value)                           \
+    do {                                                            \
+        _gen_private_put((gen), (void *)(value));                   \
+        bpd_yield(bp_num);                                          \
+    } while (0)
+
+/*********************************************************
+ *@brief: 
+ ***End the producer, used in place of task_asyn_return by the producer task function
+ *
+ *@parameter:
+ *[gen]: generator
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***结束生产者，由生产者任务函数代替task_asyn_return使用
+ *
+ *@参数：
+ *[gen]：生成器
+ **********************************************************/
+static inline void gen_return(gen_t *gen)
+{
+    gen->state = GEN_STATE_DONE;
+
+    if (gen->next_ev != NULL)
+    {
+        el_event_post(gen->next_ev);
+        gen->next_ev = NULL;
+    }
+
+    task_asyn_return(&gen->task);
+}
+
+/*********************************************************
+ *@brief: 
+ ***Check whether the generator has ended
+ *
+ *@parameter:
+ *[gen]: generator
+ *
+ *@return:
+ *[true]: ended, no more values
+ *[false]: not ended
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***检查生成器是否已结束
+ *
+ *@参数：
+ *[gen]：生成器
+ *
+ *@返回：
+ *[true]：已结束，没有更多的值
+ *[false]：未结束
+ **********************************************************/
+static inline bool gen_is_done(gen_t *gen)
+{
+    return gen->state == GEN_STATE_DONE;
+}
+
+/*********************************************************
+ *@brief: 
+ ***Get the next value of the generator. The suspended producer is resumed
+ ***directly, if it yields the value synchronously there is no event involved.
+ ***Otherwise ev is posted when the value has been stored to out
+ ***or the generator has ended (gen_is_done).
+ *
+ *@parameter:
+ *[gen]: generator
+ *[out]: receives the value, must stay valid while waiting
+ *[ev]: event of the consumer
+ *
+ *@return:
+ *[true]: the value is in out
+ *[false]: the generator has ended, or ev will be posted
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***获取生成器的下一个值。直接恢复挂起的生产者，
+ ***若其同步产出值则不涉及任何事件。
+ ***否则在值存入out或生成器结束（gen_is_done）时提交ev
+ *
+ *@参数：
+ *[gen]：生成器
+ *[out]：接收值，等待期间须保持有效
+ *[ev]：消费者的事件
+ *
+ *@返回：
+ *[true]：值已存入out
+ *[false]：生成器已结束，或ev将被提交
+ **********************************************************/
+static inline bool gen_next(gen_t *gen, void **out, event_t *ev)
+{
+    if (gen->state == GEN_STATE_SUSPENDED)
+    {
+        gen->state = GEN_STATE_RUNNING;
+        el_event_sync_post(&gen->task.event);
+    }
+
+    if (gen->state == GEN_STATE_READY)
+    {
+        *out = gen->value;
+        gen->state = GEN_STATE_SUSPENDED;
+
+        return true;
+    }
+
+    if (gen->state == GEN_STATE_RUNNING)
+    {
+        gen->out = out;
+        gen->next_ev = ev;
+    }
+
+    return false;
+}
+
+/*********************************************************
+ *@brief: 
+ ***Cancel the wait of gen_next
  *
  *@parameter:
- *[task]: task object
- *[vars_size]: The size of the asynchronous variables
+ *[gen]: generator
  *
- *@return: Memory address of an asynchronous variables
+ *@return:
+ *[true]: cancelled
+ *[false]: no consumer is waiting, ev may still be in the event loop
  *********************************************************/
 /*********************************************************
  *@简要：
- ***获取当前task堆栈中的异步变量
- ***
- ***task在首次调用时，将产生分配内存的操作，
- ***bpd_yield导致bp不为0后，再次获取，则返回以前的内存
- *
- *@约定：
- ***不能使用空指针
+ ***取消gen_next的等待
  *
  *@参数：
- *[task]：任务对象
- *[vars_size]：异步变量的大小
+ *[gen]：生成器
  *
- *@返回：异步变量的内存地址
+ *@返回：
+ *[true]：已取消
+ *[false]：没有等待中的消费者，ev可能仍在事件循环中
  **********************************************************/
-static inline void *task_asyn_vars_get(task_t *task, size_t vars_size)
+static inline bool gen_next_cancel(gen_t *gen)
 {
-    if (task->cur_ctx.bp == BP_INIT_VAL)
+    if (gen->next_ev == NULL)
     {
-        size_t alloc_size = ALIGN_UP(vars_size);
-
-        TASK_INFO((task), (task->stack.end - task->stack.start), (task->stack.cur + alloc_size - task->stack.start));
-        TASK_ASSERT(task->stack.cur + alloc_size <= task->stack.end);
-
-        task->cur_ctx.stack_used = alloc_size;
+        return false;
     }
 
-    return task->stack.cur;
-}
+    gen->next_ev = NULL;
 
+    return true;
+}
 
 /*********************************************************
  *@brief: 
- ***The function called asynchronously returns to the caller
- ***
- ***Any function called by task_bpd_asyn_call should use this method to return to the caller
+ ***Used in the bpd coroutine of the consumer, get the next value
+ ***and yield until it is available. Check gen_is_done afterwards.
  *
  *@contract: 
- ***Cannot use null pointer
+ ***out and ev are asynchronous variables or belong to the task
  *
  *@parameter:
- *[task]: task object
+ *[bp_num]: breakpoint number
+ *[gen]: generator
+ *[out]: pointer to the variable receiving the value
+ *[ev]: event of the consumer
  *********************************************************/
 /*********************************************************
  *@简要：
- ***被异步调用的函数返回到调用者
- ***
- ***任何由task_bpd_asyn_call调用的函数，应当使用此方法返回到调用者
+ ***在消费者的bpd协程中使用，获取下一个值，不可用时挂起。
+ ***之后使用gen_is_done检查是否已结束
  *
  *@约定：
- ***不能使用空指针
+ ***out与ev为异步变量或属于任务
  *
  *@参数：
- *[task]：任务对象
+ *[bp_num]：断点号
+ *[gen]：生成器
+ *[out]：接收值的变量的指针
+ *[ev]：消费者的事件
  **********************************************************/
-static inline void task_asyn_return(task_t *task)
-{
-    if (task->stack.cur >= task->stack.start + TASK_STACK_CTX_SIZE)
-    {
-        /* Restore caller context information and event callbacks */
-        /* 恢复调用者上下文信息及事件回调 */
-        task->stack.cur -= TASK_STACK_CTX_SIZE;
-        task->cur_ctx = *(struct task_cur_ctx_s *)task->stack.cur;
-        EVENT_CALLBACK(&task->event) = *(event_cb *)(task->stack.cur + sizeof(struct task_cur_ctx_s));
-        task->stack.cur -= task->cur_ctx.stack_used;
-
-        TASK_ASSERT(task->stack.cur >= task->stack.start && task->stack.cur <= task->stack.end);
-
-        if (task->cur_ctx.yield_state)
-        {
-            /* Immediate return to the caller */
-            /* 立即返回调用者 */
-            el_event_sync_post(&task->event);
-        }
-    }
-    /* task end */
-    /* 任务结束 */
-    else
-    {
-        task->stack.cur = task->stack.start;
-        task->ret_val.ptr = NULL;
-        task->cur_ctx.stack_used = 0;
-        task->cur_ctx.bp = BP_INIT_VAL;
-        task->cur_ctx.yield_state = 0;
-        EVENT_CALLBACK(&(task)->event) = (event_cb)NULL_CB;
-
-        while (!lifo_is_empty(&task->task_end_notify_q))
-        {
-            /* Asynchronous post events can avoid errors caused by freeing task in callbacks */
-            /* 异步提交事件可避免在回调中释放task而引起错误 */
-            el_event_post(EVENT_OF_NODE(lifo_pop(&task->task_end_notify_q)));
-        }
-    }
-}
+#define gen_bpd_next(bp_num, gen, out, ev)                          \
+    do {                                                            \
+        if (!gen_next((gen), (void **)(out), (ev))                  \
+            && !gen_is_done(gen))                                   \
+        {                                                           \
+            bpd_yield(bp_num);                                      \
+        }                                                           \
+    } while (0)
 
+#ifdef CONFIG_TASK_STACKFUL
 
 /*********************************************************
- *@brief: 
- ***Determine if the coroutine task is end
+ *@type description:
  *
- *@return:
- *[true]: task is end
- *[false]: task not end
- *********************************************************/
-/*********************************************************
- *@简要：
- ***判断协程任务是否结束
+ *[task_stackful_routine_t]: function of a stackful task
+ *********************************************************
+ *@类型说明：
  *
- *@返回：
- *[true]：任务已结束
- *[false]: 任务未结束
- **********************************************************/
-static inline bool task_is_end(task_t *task)
+ *[task_stackful_routine_t]：有栈任务的函数
+ *********************************************************/
+typedef void (*task_stackful_routine_t)(task_t *task, void *arg);
+
+#define task_ctx_switch EL_MACRO_CONCAT(task_ctx_switch_m_, CONFIG_EL_MOUDLE_ID)
+#define task_ctx_make EL_MACRO_CONCAT(task_ctx_make_m_, CONFIG_EL_MOUDLE_ID)
+
+/* Save the registers to the current stack, store its pointer to *save_sp, switch to sp; defined in atask.c */
+/* 将寄存器保存到当前栈，栈指针存入*save_sp，切换到sp；定义于atask.c */
+extern void task_ctx_switch(void **save_sp, void *sp);
+
+/* Build the initial context of a stackful task on its stack, return the stack pointer; defined in atask.c */
+/* 在有栈任务的栈上构建初始上下文，返回栈指针；定义于atask.c */
+extern void *task_ctx_make(task_t *task, task_stackful_routine_t func, void *arg);
+
+/* Event callback of a stackful task: switch into the task until it yields or ends */
+/* 有栈任务的事件回调：切换到任务中，直到其挂起或结束 */
+static inline void _task_stackful_private_resume(task_t *task, event_t *ev)
 {
-    return EVENT_CALLBACK(&(task)->event) == (event_cb)NULL_CB;
+    task->sf_ev = ev;
+    task_ctx_switch(&task->sf_caller_sp, task->sf_sp);
+
+    /* The task function has returned, end the task on the stack of the event loop */
+    /* 任务函数已返回，在事件循环的栈上结束任务 */
+    if (task->sf_sp == NULL)
+    {
+        task_asyn_return(task);
+    }
 }
 
 
 /*********************************************************
  *@brief: 
- ***Add a listen event for the end action of the coroutine task,
- ***and trigger the listen event when the coroutine task ends.
+ ***Start a stackful task, the task function runs on the task stack
+ ***until it calls task_stackful_yield or returns.
+ ***The task ends when the function returns, like a task of task_start.
  *
  *@contract: 
- ***The task_asyn_return must be called at 
- ***the end of the topmost coroutine (started by task_start)
+ ***1. The task stack is large enough for the C calls of the function
+ ***2. The task has ended (task_is_end)
  *
  *@parameter:
  *[task]: task object
- *[task_end_notify_ev]: Event for listening to coroutine exit
- *
- *@return:
- *[true]: Add a listen event successfully
- *[false]: Listening events are in the reference state or in the queue
+ *[func]: task function
+ *[arg]: argument of the function
  *********************************************************/
 /*********************************************************
  *@简要：
- ***为协程任务的结束动作添加一个监听事件，协程任务结束时将触发
- ***监听的事件
+ ***启动有栈任务，任务函数在任务栈上运行，
+ ***直到其调用task_stackful_yield或返回。
+ ***函数返回时任务结束，与task_start的任务相同
  *
  *@约定：
- ***1、最上层的协程(由task_start启动)结束时必须调用task_asyn_return
+ ***1、任务栈足够容纳该函数的C调用
+ ***2、任务已结束（task_is_end）
  *
  *@参数：
  *[task]：任务对象
- *[task_end_notify_ev]：用于监听协程退出的事件
- *
- *@返回值：
- *[true]：添加监听事件成功
- *[false]：监听事件处于引用状态或者队列中
+ *[func]：任务函数
+ *[arg]：函数的参数
  **********************************************************/
-static inline bool task_end_wait(task_t *task, event_t *task_end_notify_ev)
+static inline void task_stackful_start(task_t *task, task_stackful_routine_t func, void *arg)
 {
-    if (!slist_node_is_del(EVENT_NODE(task_end_notify_ev)))
-    {
-        return false;
-    }
-
-    lifo_push(&task->task_end_notify_q, EVENT_NODE(task_end_notify_ev));
-
-    return true;
+    task->sf_sp = task_ctx_make(task, func, arg);
+    EVENT_CALLBACK(&task->event) = (event_cb)_task_stackful_private_resume;
+    _task_stackful_private_resume(task, NULL);
 }
 
-
 /*********************************************************
  *@brief: 
- ***Cancel the event listener for task_end_wait
+ ***Used in a stackful task, suspend until an event of the task is triggered.
+ ***The events waited for are initialized with the xxx_init_inherit functions
+ ***from the task event, as in bpd coroutines.
  *
  *@parameter:
  *[task]: task object
- *[task_end_notify_ev]: The event used by task_end_wait
  *
- *@return:
- *[true]: Cancel the listen event successfully
- *[false]: The listened event is no in the listen queue
+ *@return: the event that resumed the task
  *********************************************************/
 /*********************************************************
  *@简要：
- ***取消task_end_wait的事件监听
+ ***在有栈任务中使用，挂起直到任务的一个事件被触发。
+ ***等待的事件与bpd协程相同，使用xxx_init_inherit从任务事件初始化
  *
  *@参数：
  *[task]：任务对象
- *[task_end_notify_ev]：传入task_end_wait的事件
  *
- *@返回值：
- *[true]：取消监听事件成功
- *[false]：监听的事件已经不在监听队列之中
+ *@返回：恢复任务的事件
  **********************************************************/
-static inline bool task_end_wait_cancel(task_t *task, event_t *task_end_notify_ev)
+static inline event_t *task_stackful_yield(task_t *task)
 {
-    if (slist_node_is_del(EVENT_NODE(task_end_notify_ev)))
-    {
-        return false;
-    }
+    task_ctx_switch(&task->sf_sp, task->sf_caller_sp);
 
-    if (el_event_is_ready(task_end_notify_ev))
-    {
-        return el_event_cancel(task_end_notify_ev);
-    }
-    else
-    {
-        return lifo_del_node(&task->task_end_notify_q, EVENT_NODE(task_end_notify_ev));
-    }
+    return task->sf_ev;
 }
 
+#endif /* CONFIG_TASK_STACKFUL */
+
 
 /************************************************************
  *@brief:
@@ -2877,6 +8547,8 @@ static inline void task_asyn_call_prepare(task_t *task, task_asyn_routine_t afun
     *(struct task_cur_ctx_s *)task->stack.cur = task->cur_ctx;
     *(event_cb *)(task->stack.cur + sizeof(struct task_cur_ctx_s)) = EVENT_CALLBACK(&task->event);
     task->stack.cur += TASK_STACK_CTX_SIZE;
+    _task_private_stack_profile_used(task, _task_private_stack_depth(task, task->stack.cur));
+    _task_private_stack_seg_reserve(task, 0);
 
     /* Initialize new context information and event callback */
     /* 初始化新的上下文信息和事件回调 */
@@ -2932,6 +8604,184 @@ static inline void task_asyn_call_prepare(task_t *task, task_asyn_routine_t afun
         bpd_restore_point(bp_num):;                                 					\
     } while (0)
 
+
+/*********************************************************
+ *@type description:
+ *
+ *[task_leaf_ctx_t]: caller context of task_bpd_leaf_call, kept on the C stack
+ ***until the callee yields for the first time
+ *[ctx]: context of the caller
+ *[callback]: event callback of the caller
+ *[slot]: place on the task stack reserved for the context
+ *********************************************************
+ *@类型说明：
+ *
+ *[task_leaf_ctx_t]：task_bpd_leaf_call的调用者上下文，
+ ***在被调用者首次挂起之前保存在C栈上
+ *[ctx]：调用者的上下文
+ *[callback]：调用者的事件回调
+ *[slot]：任务栈上为上下文预留的位置
+ *********************************************************/
+typedef struct task_leaf_ctx_s
+{
+    struct task_cur_ctx_s ctx;
+    event_cb callback;
+    uint8_t *slot;
+} task_leaf_ctx_t;
+
+
+/************************************************************
+ *@brief:
+ ***Reserve the caller context on the stack without saving it,
+ ***and initializes new context information
+ ***
+ ***This function is used by task_bpd_leaf_call and should not be used directly.
+ *
+ *@parameter:
+ *[task]: task object
+ *[afunc]: Called asynchronous function
+ *[leaf]: caller context
+ *************************************************************/
+/************************************************************
+ *@简介：
+ ***在栈上为调用者上下文预留位置但不保存，并初始化新的上下文信息
+ ***
+ ***此函数由task_bpd_leaf_call使用，不应该被直接使用
+ *
+ *@参数：
+ *[task]：任务对象
+ *[afunc]：被调用的异步函数
+ *[leaf]：调用者上下文
+ *************************************************************/
+static inline void task_asyn_leaf_prepare(task_t *task, task_asyn_routine_t afunc, task_leaf_ctx_t *leaf)
+{
+    TASK_ASSERT(task->stack.cur + task->cur_ctx.stack_used + TASK_STACK_CTX_SIZE <= task->stack.end);
+
+    leaf->ctx = task->cur_ctx;
+    leaf->callback = EVENT_CALLBACK(&task->event);
+    task->stack.cur += task->cur_ctx.stack_used;
+    leaf->slot = task->stack.cur;
+    task->stack.cur += TASK_STACK_CTX_SIZE;
+    _task_private_stack_profile_used(task, _task_private_stack_depth(task, task->stack.cur));
+    _task_private_stack_seg_reserve(task, 0);
+
+    /* The callback is switched now, the events inherited by the callee copy it */
+    /* 回调在此时切换，被调用者继承的事件会复制它 */
+    task->cur_ctx.bp = BP_INIT_VAL;
+    task->cur_ctx.stack_used = 0;
+    task->cur_ctx.yield_state = TASK_YIELD_STATE_LEAF;
+    EVENT_CALLBACK(&task->event) = (event_cb)afunc;
+}
+
+
+/************************************************************
+ *@brief:
+ ***Finish a leaf call after the callee returns to the C caller:
+ ***restore the caller context if the callee completed synchronously,
+ ***otherwise save it to the reserved place so that task_asyn_return
+ ***resumes the caller later
+ ***
+ ***This function is used by task_bpd_leaf_call and should not be used directly.
+ *
+ *@parameter:
+ *[task]: task object
+ *[leaf]: caller context
+ *
+ *@return:
+ *[true]: completed synchronously, the caller continues
+ *[false]: the callee yielded, the caller yields too
+ *************************************************************/
+/************************************************************
+ *@简介：
+ ***被调用者返回到C调用者后完成叶调用：
+ ***被调用者同步完成则恢复调用者上下文，
+ ***否则将其保存到预留位置，使task_asyn_return稍后恢复调用者
+ ***
+ ***此函数由task_bpd_leaf_call使用，不应该被直接使用
+ *
+ *@参数：
+ *[task]：任务对象
+ *[leaf]：调用者上下文
+ *
+ *@返回：
+ *[true]：同步完成，调用者继续执行
+ *[false]：被调用者已挂起，调用者也须挂起
+ *************************************************************/
+static inline bool task_asyn_leaf_finish(task_t *task, task_leaf_ctx_t *leaf)
+{
+    if (task->stack.cur == leaf->slot)
+    {
+        task->stack.cur -= leaf->ctx.stack_used;
+        task->cur_ctx = leaf->ctx;
+        EVENT_CALLBACK(&task->event) = leaf->callback;
+
+        return true;
+    }
+
+    /* The first real yield, materialise the caller context */
+    /* 首次真正挂起，保存调用者上下文 */
+    leaf->ctx.yield_state = 1;
+    *(struct task_cur_ctx_s *)leaf->slot = leaf->ctx;
+    *(event_cb *)(leaf->slot + sizeof(struct task_cur_ctx_s)) = leaf->callback;
+
+    /* The callee yielded by itself, it returns through the saved context from now on */
+    /* 被调用者自身挂起，此后经由保存的上下文返回 */
+    if (task->cur_ctx.yield_state == TASK_YIELD_STATE_LEAF)
+    {
+        task->cur_ctx.yield_state = 0;
+    }
+
+    return false;
+}
+
+
+/*********************************************************
+ *@brief: 
+ ***Same as task_bpd_asyn_call, for callees that usually complete synchronously.
+ ***The caller context stays on the C stack while the callee runs and is
+ ***saved to the task stack only when the callee yields for the first time,
+ ***so a synchronous completion does not touch the task stack for the context.
+ *
+ *@contract: 
+ ***Cannot use null pointer
+ *
+ *@parameter:
+ *[bp_num]：For asynchronous return, bpd breakpoint number
+ *[task]：Task object
+ *[afunc]：The asynchronous function being called
+ *[...]：The second argument after the called asynchronous function
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***与task_bpd_asyn_call相同，用于通常同步完成的被调用者。
+ ***被调用者运行期间调用者上下文保存在C栈上，
+ ***仅在被调用者首次挂起时才保存到任务栈，
+ ***因此同步完成时不会为上下文访问任务栈
+ *
+ *@约定：
+ ***不能使用空指针
+ *
+ *@参数：
+ *[bp_num]：用于异步返回的，bpd断点号
+ *[task]：任务对象
+ *[afunc]：被调用的异步函数
+ *[...]：被调用的异步函数的第二个之后的参数
+ **********************************************************/
+#define task_bpd_leaf_call(bp_num, task, afunc, ...)                					\
+    do {                                                            					\
+        bpd_set(bp_num);                                            					\
+        {                                                           					\
+            task_leaf_ctx_t _leaf_ctx;                              					\
+            task_asyn_leaf_prepare((task), (task_asyn_routine_t)afunc, &_leaf_ctx);		\
+            afunc((task), (event_t *)NULL, ##__VA_ARGS__);          					\
+            if (!task_asyn_leaf_finish((task), &_leaf_ctx))         					\
+            {                                                       					\
+                return ;                                            					\
+            }                                                       					\
+        }                                                           					\
+        bpd_restore_point(bp_num):;                                 					\
+    } while (0)
+
 /*********************************************************
 *@description:
 ***private functions
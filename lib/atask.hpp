@@ -0,0 +1,629 @@
+﻿/*
+ * Copyright (C) 2018-2019 xiaoliang<1296283984@qq.com>.
+ */
+
+#ifndef __LIB_ATASK_HPP__
+#define __LIB_ATASK_HPP__
+
+#include "atask.h"
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <utility>
+
+#if !defined(__cpp_impl_coroutine) || __cpp_impl_coroutine < 201902L
+#error "atask.hpp requires C++20 coroutines"
+#endif
+
+/*********************************************************
+ *@description:
+ ***C++20 coroutine adapter of libatask.
+ ***A co_task<T> is a lazily started coroutine whose frame is allocated
+ ***from a slab_t (see frame_slab_set), the global heap is never used.
+ ***Awaiting an event_t, a timer, a sem_t or a slab_t arms an event
+ ***whose callback resumes the coroutine, so every resumption is
+ ***dispatched by the event loop with the priority of the coroutine,
+ ***exactly like the events of a bp task.
+ ***Awaiting another co_task runs it in place (symmetric transfer),
+ ***the callee inherits the priority of the caller.
+ *********************************************************
+ *@说明：
+ ***libatask的C++20协程适配。
+ ***co_task<T>为惰性启动的协程，其协程帧从slab_t中分配（见frame_slab_set），
+ ***不使用全局堆。等待event_t、定时器、sem_t或slab_t时将设置一个事件，
+ ***其回调恢复协程，因此每次恢复都由事件循环按协程的优先级调度，
+ ***与bp任务的事件完全相同。
+ ***等待另一个co_task时直接运行该协程（对称转移），被调用者继承调用者的优先级。
+ *********************************************************/
+
+namespace atask {
+
+/*********************************************************
+ *@description:
+ ***Frame allocator.
+ ***Each frame is a slab block prefixed by a header of frame_align bytes
+ ***holding the pointer of its slab, so frames are freed to the slab
+ ***they came from even if frame_slab_set is called again, and keep the
+ ***alignment of the block. The buffer of the slab is aligned to
+ ***frame_align and its block size is a multiple of it (frame_blk_size),
+ ***as the compiler assumes frames aligned like operator new.
+ ***When the slab is not set, exhausted, its blocks are smaller than the
+ ***frame or misaligned, the co_task is empty (operator bool is false)
+ ***and must not be started or awaited.
+ ***frame_size_peak records the largest frame requested, to size the blocks
+ *********************************************************
+ *@说明：
+ ***协程帧分配器。
+ ***每个协程帧为一个slab块，块首为frame_align字节的头部，保存所属slab的指针，
+ ***因此即使再次调用frame_slab_set，协程帧也会归还到其来源slab，
+ ***且保持块的对齐。slab的buffer须按frame_align对齐，块大小须为其整数倍
+ ***（frame_blk_size），因为编译器假定协程帧与operator new的对齐相同。
+ ***slab未设置、已耗尽、块小于协程帧或未对齐时，co_task为空
+ ***（operator bool为false），不能启动或等待。
+ ***frame_size_peak记录请求过的最大协程帧，用于确定块大小
+ *********************************************************/
+inline slab_t *frame_slab = nullptr;
+inline std::size_t frame_size_peak = 0;
+
+/* alignment of the frames, also the size of the frame header */
+/* 协程帧的对齐，同时也是协程帧头部的大小 */
+inline constexpr std::size_t frame_align = alignof(std::max_align_t);
+
+static inline void frame_slab_set(slab_t *slab)
+{
+    frame_slab = slab;
+}
+
+/* block size of the frame slab for frames up to frame_size */
+/* 容纳frame_size大小协程帧所需的slab块大小 */
+static inline constexpr std::size_t frame_blk_size(std::size_t frame_size)
+{
+    return frame_align + (frame_size + frame_align - 1) / frame_align * frame_align;
+}
+
+/*********************************************************
+ *@description:
+ ***Common part of the promise types: frame allocation, priority,
+ ***the awaiting coroutine to continue at the end and the detached flag
+ *********************************************************
+ *@说明：
+ ***promise类型的公共部分：协程帧分配、优先级、
+ ***结束时继续运行的等待者协程以及分离标志
+ *********************************************************/
+struct promise_base
+{
+    std::coroutine_handle<> continuation;
+    uint8_t priority = 0;
+    bool detached = false;
+
+    static void *operator new(std::size_t size) noexcept
+    {
+        slab_t *slab = frame_slab;
+        slab_t **blk;
+
+        if (size > frame_size_peak)
+        {
+            frame_size_peak = size;
+        }
+
+        if (slab == nullptr || frame_blk_size(size) > slab_blk_size_get(slab))
+        {
+            return nullptr;
+        }
+
+        blk = (slab_t **)slab_alloc(slab);
+
+        if (blk == nullptr)
+        {
+            return nullptr;
+        }
+
+        if ((uintptr_t)blk % frame_align != 0)
+        {
+            slab_free(slab, blk);
+            return nullptr;
+        }
+
+        blk[0] = slab;
+
+        return (uint8_t *)blk + frame_align;
+    }
+
+    static void operator delete(void *frame) noexcept
+    {
+        slab_t **blk = (slab_t **)((uint8_t *)frame - frame_align);
+
+        slab_free(blk[0], blk);
+    }
+
+    std::suspend_always initial_suspend() noexcept
+    {
+        return {};
+    }
+
+    /* continue the awaiting coroutine, or free a detached frame */
+    /* 继续运行等待者协程，或释放已分离的协程帧 */
+    struct final_awaiter
+    {
+        bool await_ready() noexcept
+        {
+            return false;
+        }
+
+        template <class P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept
+        {
+            promise_base &p = h.promise();
+
+            if (p.continuation)
+            {
+                return p.continuation;
+            }
+
+            if (p.detached)
+            {
+                h.destroy();
+            }
+
+            return std::noop_coroutine();
+        }
+
+        void await_resume() noexcept
+        {
+        }
+    };
+
+    final_awaiter final_suspend() noexcept
+    {
+        return {};
+    }
+
+    void unhandled_exception() noexcept
+    {
+        std::terminate();
+    }
+};
+
+template <class T, class Promise>
+class co_task_base
+{
+public:
+    using handle_t = std::coroutine_handle<Promise>;
+
+    co_task_base() noexcept = default;
+
+    explicit co_task_base(handle_t h) noexcept : handle(h)
+    {
+    }
+
+    co_task_base(co_task_base &&other) noexcept : handle(std::exchange(other.handle, nullptr))
+    {
+    }
+
+    co_task_base &operator=(co_task_base &&other) noexcept
+    {
+        if (this != &other)
+        {
+            if (handle)
+            {
+                handle.destroy();
+            }
+
+            handle = std::exchange(other.handle, nullptr);
+        }
+
+        return *this;
+    }
+
+    ~co_task_base()
+    {
+        if (handle)
+        {
+            handle.destroy();
+        }
+    }
+
+    /* false when the frame allocation failed */
+    /* 协程帧分配失败时为false */
+    explicit operator bool() const noexcept
+    {
+        return (bool)handle;
+    }
+
+    bool done() const noexcept
+    {
+        return handle.done();
+    }
+
+    /*********************************************************
+     *@brief:
+     ***Run the coroutine until its first suspension,
+     ***the events it waits are posted with the priority
+     *********************************************************
+     *@简要：
+     ***运行协程直到其首次挂起，其等待的事件以priority优先级提交
+     *********************************************************/
+    void start(uint8_t priority = 0)
+    {
+        handle.promise().priority = priority;
+        handle.resume();
+    }
+
+    /* awaiting a co_task runs it in place and returns its co_return value */
+    /* 等待co_task时直接运行该协程，并返回其co_return的值 */
+    struct awaiter
+    {
+        handle_t handle;
+
+        bool await_ready() noexcept
+        {
+            return false;
+        }
+
+        template <class P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> caller) noexcept
+        {
+            handle.promise().continuation = caller;
+            handle.promise().priority = caller.promise().priority;
+
+            return handle;
+        }
+
+        T await_resume()
+        {
+            return handle.promise().result();
+        }
+    };
+
+    awaiter operator co_await() && noexcept
+    {
+        return awaiter{handle};
+    }
+
+protected:
+    handle_t handle = nullptr;
+};
+
+/*********************************************************
+ *@description:
+ ***Coroutine task returning T with co_return (T must be default constructible).
+ ***It is started with start, spawn, or by being awaited from another co_task
+ *********************************************************
+ *@说明：
+ ***使用co_return返回T的协程任务（T须可默认构造）。
+ ***使用start、spawn启动，或在另一个co_task中被等待时启动
+ *********************************************************/
+template <class T = void>
+class co_task;
+
+template <class T>
+struct co_promise : promise_base
+{
+    T value{};
+
+    co_task<T> get_return_object() noexcept;
+
+    static co_task<T> get_return_object_on_allocation_failure() noexcept;
+
+    void return_value(T v)
+    {
+        value = std::move(v);
+    }
+
+    T result()
+    {
+        return std::move(value);
+    }
+};
+
+template <>
+struct co_promise<void> : promise_base
+{
+    co_task<void> get_return_object() noexcept;
+
+    static co_task<void> get_return_object_on_allocation_failure() noexcept;
+
+    void return_void() noexcept
+    {
+    }
+
+    void result() noexcept
+    {
+    }
+};
+
+template <class T>
+class co_task : public co_task_base<T, co_promise<T>>
+{
+public:
+    using promise_type = co_promise<T>;
+    using co_task_base<T, co_promise<T>>::co_task_base;
+
+    /* give up the ownership, the frame is freed when the coroutine ends */
+    /* 放弃所有权，协程结束时释放协程帧 */
+    void detach() noexcept
+    {
+        this->handle.promise().detached = true;
+        this->handle = nullptr;
+    }
+};
+
+template <class T>
+inline co_task<T> co_promise<T>::get_return_object() noexcept
+{
+    return co_task<T>(std::coroutine_handle<co_promise<T>>::from_promise(*this));
+}
+
+template <class T>
+inline co_task<T> co_promise<T>::get_return_object_on_allocation_failure() noexcept
+{
+    return co_task<T>();
+}
+
+inline co_task<void> co_promise<void>::get_return_object() noexcept
+{
+    return co_task<void>(std::coroutine_handle<co_promise<void>>::from_promise(*this));
+}
+
+inline co_task<void> co_promise<void>::get_return_object_on_allocation_failure() noexcept
+{
+    return co_task<void>();
+}
+
+/*********************************************************
+ *@brief:
+ ***Start a coroutine and detach it, the frame returns to its slab at the end
+ *
+ *@return value:
+ *[true]: started
+ *[false]: the frame allocation failed
+ *********************************************************
+ *@简要：
+ ***启动协程并分离，协程结束时协程帧归还到其slab
+ *
+ *@返回值：
+ *[true]：已启动
+ *[false]：协程帧分配失败
+ *********************************************************/
+static inline bool spawn(co_task<void> &&task, uint8_t priority = 0)
+{
+    co_task<void> t = std::move(task);
+
+    if (!t)
+    {
+        return false;
+    }
+
+    t.start(priority);
+
+    if (t.done())
+    {
+        return true;
+    }
+
+    t.detach();
+
+    return true;
+}
+
+/*********************************************************
+ *@description:
+ ***Base of the awaiters: an event whose callback resumes the coroutine,
+ ***initialized with the priority of the awaiting coroutine
+ *********************************************************
+ *@说明：
+ ***等待器的基类：回调为恢复协程的事件，以等待者协程的优先级初始化
+ *********************************************************/
+struct event_awaiter
+{
+    static void resume_cb(void *ctx, event_t *)
+    {
+        std::coroutine_handle<>::from_address(ctx).resume();
+    }
+
+    template <class P>
+    static void event_prepare(event_t *ev, std::coroutine_handle<P> h) noexcept
+    {
+        event_init(ev, resume_cb, h.address(), h.promise().priority);
+    }
+};
+
+/*********************************************************
+ *@brief:
+ ***Wait for an event armed by arm(event_t *), arm posts the event
+ ***itself when there is nothing to wait for, such as
+ ***co_await wait([&](event_t *ev) {
+ ***    if (future_await(&future, ev) != FUTURE_AWAIT_PENDING) el_event_post(ev); })
+ *
+ *@return value:
+ ***the event after it has been dispatched
+ *********************************************************
+ *@简要：
+ ***等待由arm(event_t *)设置的事件，无需等待时由arm自行提交该事件，如：
+ ***co_await wait([&](event_t *ev) {
+ ***    if (future_await(&future, ev) != FUTURE_AWAIT_PENDING) el_event_post(ev); })
+ *
+ *@返回值：
+ ***被调度后的事件
+ *********************************************************/
+template <class F>
+struct wait_awaiter : event_awaiter
+{
+    F arm;
+    event_t ev;
+
+    bool await_ready() noexcept
+    {
+        return false;
+    }
+
+    template <class P>
+    void await_suspend(std::coroutine_handle<P> h)
+    {
+        event_prepare(&ev, h);
+        arm(&ev);
+    }
+
+    event_t *await_resume() noexcept
+    {
+        return &ev;
+    }
+};
+
+template <class F>
+static inline wait_awaiter<F> wait(F arm)
+{
+    return wait_awaiter<F>{{}, std::move(arm), {}};
+}
+
+/*********************************************************
+ *@brief:
+ ***Give up the CPU, the coroutine is resumed by the event loop
+ ***after the pending events of higher or equal priority
+ *********************************************************
+ *@简要：
+ ***让出CPU，协程在已挂起的更高或相同优先级的事件之后由事件循环恢复
+ *********************************************************/
+struct yield_awaiter : event_awaiter
+{
+    event_t ev;
+
+    bool await_ready() noexcept
+    {
+        return false;
+    }
+
+    template <class P>
+    void await_suspend(std::coroutine_handle<P> h) noexcept
+    {
+        event_prepare(&ev, h);
+        el_event_post(&ev);
+    }
+
+    void await_resume() noexcept
+    {
+    }
+};
+
+static inline yield_awaiter yield() noexcept
+{
+    return yield_awaiter{};
+}
+
+/*********************************************************
+ *@brief:
+ ***co_await sleep_ms(ms), resume the coroutine after ms milliseconds
+ *********************************************************
+ *@简要：
+ ***co_await sleep_ms(ms)，ms毫秒后恢复协程
+ *********************************************************/
+struct sleep_awaiter : event_awaiter
+{
+    time_ms_t ms;
+    timer_event_t timer;
+
+    bool await_ready() noexcept
+    {
+        return false;
+    }
+
+    template <class P>
+    void await_suspend(std::coroutine_handle<P> h) noexcept
+    {
+        event_prepare(&timer.event, h);
+        timer.due = 0;
+        el_timer_start_ms(&timer, ms);
+    }
+
+    void await_resume() noexcept
+    {
+    }
+};
+
+static inline sleep_awaiter sleep_ms(time_ms_t ms) noexcept
+{
+    return sleep_awaiter{{}, ms, {}};
+}
+
+/*********************************************************
+ *@brief:
+ ***co_await take(sem), take the semaphore,
+ ***the coroutine is suspended only when the semaphore is not available
+ *********************************************************
+ *@简要：
+ ***co_await take(sem)，获取信号量，仅当信号量不可用时挂起协程
+ *********************************************************/
+struct sem_awaiter : event_awaiter
+{
+    sem_t *sem;
+    event_t ev;
+
+    bool await_ready() noexcept
+    {
+        return sem_take(sem, NULL);
+    }
+
+    template <class P>
+    void await_suspend(std::coroutine_handle<P> h) noexcept
+    {
+        event_prepare(&ev, h);
+        sem_take(sem, &ev);
+    }
+
+    void await_resume() noexcept
+    {
+    }
+};
+
+static inline sem_awaiter take(sem_t *sem) noexcept
+{
+    return sem_awaiter{{}, sem, {}};
+}
+
+/*********************************************************
+ *@brief:
+ ***co_await alloc(slab), allocate a block from the slab,
+ ***the coroutine is suspended only when the slab is exhausted
+ *
+ *@return value:
+ ***the memory block
+ *********************************************************
+ *@简要：
+ ***co_await alloc(slab)，从slab中分配一个块，仅当slab耗尽时挂起协程
+ *
+ *@返回值：
+ ***分配的内存块
+ *********************************************************/
+struct slab_awaiter : event_awaiter
+{
+    slab_t *slab;
+    slab_alloc_event_t alloc_ev;
+
+    bool await_ready() noexcept
+    {
+        alloc_ev.mem_blk = slab_alloc(slab);
+
+        return alloc_ev.mem_blk != NULL;
+    }
+
+    template <class P>
+    void await_suspend(std::coroutine_handle<P> h) noexcept
+    {
+        event_prepare(&alloc_ev.event, h);
+        slab_wait(slab, &alloc_ev);
+    }
+
+    void *await_resume() noexcept
+    {
+        return alloc_ev.mem_blk;
+    }
+};
+
+static inline slab_awaiter alloc(slab_t *slab) noexcept
+{
+    return slab_awaiter{{}, slab, {}};
+}
+
+} /* namespace atask */
+
+#endif /* __LIB_ATASK_HPP__ */
@@ -0,0 +1,529 @@
+﻿/*
+ * Copyright (C) 2018-2019 xiaoliang<1296283984@qq.com>.
+ */
+
+#ifndef __LIB_BUF_H__
+#define __LIB_BUF_H__
+
+#include "atask.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************************************************
+ *@description:
+ ***Reference counted buffers backed by the size classes of a slab_cache_t.
+ ***A buffer (buf_t) is released back to its slab when the last reference is put.
+ ***A slice (buf_slice_t) is an offset and length view holding a reference
+ ***of the buffer, slices are linked into a chain (buf_chain_t) which can be
+ ***converted to an iovec-like array for scatter/gather I/O, so one buffer can
+ ***be sent to many sockets or cached without copying.
+ ***
+ ***The reference count is not atomic, buffers belong to one event loop.
+ *********************************************************
+ *@说明：
+ ***基于slab_cache_t大小类的引用计数缓冲区。
+ ***缓冲区（buf_t）在最后一个引用被释放时归还到其所属的slab。
+ ***切片（buf_slice_t）是持有缓冲区引用的偏移与长度视图，切片可链接成链
+ ***（buf_chain_t），并转换为类似iovec的数组用于分散/聚集I/O，
+ ***使一个缓冲区可被发送到多个套接字或被缓存而无需复制。
+ ***
+ ***引用计数不是原子的，缓冲区属于一个事件循环
+ *********************************************************/
+
+
+/*********************************************************
+ *@type description:
+ *
+ *[buf_t]: reference counted buffer, the data follows the header in the same block
+ *[buf_slice_t]: view of a buffer, holds a reference of the buffer
+ *[buf_chain_t]: chain of slices
+ *[buf_iov_t]: iovec-like element
+ *********************************************************
+ *@类型说明：
+ *
+ *[buf_t]：引用计数缓冲区，数据在同一块中紧随头部
+ *[buf_slice_t]：缓冲区的视图，持有缓冲区的引用
+ *[buf_chain_t]：切片链
+ *[buf_iov_t]：类似iovec的元素
+ *********************************************************/
+typedef struct buf_s
+{
+    /* slab cache of the buffer */
+    /* 缓冲区所属的slab cache */
+    slab_cache_t *cache;
+
+    /* reference count */
+    /* 引用计数 */
+    uint32_t ref;
+
+    /* capacity of the data */
+    /* 数据容量 */
+    uint32_t size;
+
+    /* length of the valid data */
+    /* 有效数据长度 */
+    uint32_t len;
+} buf_t;
+
+typedef struct buf_slice_s
+{
+    /* chain node */
+    /* 链节点 */
+    slist_node_t node;
+
+    /* buffer */
+    /* 缓冲区 */
+    buf_t *buf;
+
+    /* offset in the buffer */
+    /* 在缓冲区中的偏移 */
+    uint32_t offset;
+
+    /* length */
+    /* 长度 */
+    uint32_t len;
+} buf_slice_t;
+
+typedef struct buf_chain_s
+{
+    /* slices */
+    /* 切片 */
+    fifo_t slices;
+
+    /* total length of the slices */
+    /* 切片的总长度 */
+    size_t len;
+} buf_chain_t;
+
+typedef struct buf_iov_s
+{
+    void *base;
+    size_t len;
+} buf_iov_t;
+
+/* Data of the buffer */
+/* 缓冲区的数据 */
+#define BUF_DATA(buf)   ((uint8_t *)(buf) + ALIGN_UP(sizeof(buf_t)))
+
+/* Data of the slice */
+/* 切片的数据 */
+#define BUF_SLICE_DATA(slice)   (BUF_DATA((slice)->buf) + (slice)->offset)
+
+/* Slice of the chain node */
+/* 链节点所属的切片 */
+#define BUF_SLICE_OF_NODE(n)    container_of(n, buf_slice_t, node)
+
+
+/*********************************************************
+ *@brief:
+ ***allocate a buffer with a reference count of 1,
+ ***the capacity is the block size of the size class minus the header
+ *
+ *@parameter:
+ *[cache]: slab cache
+ *[size]: minimum capacity of the data
+ *
+ *@return value:
+ *[NULL]: no memory
+ *[other]: buffer
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***分配一个引用计数为1的缓冲区，容量为大小类的块大小减去头部
+ *
+ *@参数：
+ *[cache]：slab cache
+ *[size]：数据的最小容量
+ *
+ *@返回值：
+ *[NULL]：没有内存
+ *[其他]：缓冲区
+ **********************************************************/
+static inline buf_t *buf_alloc(slab_cache_t *cache, uint32_t size)
+{
+    buf_t *buf = (buf_t *)slab_cache_alloc(cache, ALIGN_UP(sizeof(buf_t)) + size);
+
+    if (buf != NULL)
+    {
+        buf->cache = cache;
+        buf->ref = 1;
+        buf->size = slab_blk_size_get(slab_cache_slab_of(cache, buf)) - (uint32_t)ALIGN_UP(sizeof(buf_t));
+        buf->len = 0;
+    }
+
+    return buf;
+}
+
+
+/*********************************************************
+ *@brief:
+ ***get a reference of the buffer
+ *
+ *@parameter:
+ *[buf]: buffer
+ *
+ *@return value:
+ ***the buffer
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***获取缓冲区的一个引用
+ *
+ *@参数：
+ *[buf]：缓冲区
+ *
+ *@返回值：
+ ***缓冲区
+ **********************************************************/
+static inline buf_t *buf_get(buf_t *buf)
+{
+    buf->ref++;
+
+    return buf;
+}
+
+
+/*********************************************************
+ *@brief:
+ ***put a reference of the buffer, the last reference releases the buffer
+ *
+ *@parameter:
+ *[buf]: buffer
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***释放缓冲区的一个引用，最后一个引用释放缓冲区
+ *
+ *@参数：
+ *[buf]：缓冲区
+ **********************************************************/
+static inline void buf_put(buf_t *buf)
+{
+    if (--buf->ref == 0)
+    {
+        slab_cache_free(buf->cache, buf);
+    }
+}
+
+
+/*********************************************************
+ *@brief:
+ ***create a slice of the buffer, the slice holds a reference of the buffer,
+ ***the slice itself is allocated from the slab cache of the buffer
+ *
+ *@parameter:
+ *[buf]: buffer
+ *[offset]: offset in the buffer
+ *[len]: length
+ *
+ *@return value:
+ *[NULL]: no memory, or offset + len exceeds the valid data of the buffer
+ *[other]: slice
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***创建缓冲区的切片，切片持有缓冲区的一个引用，
+ ***切片本身从缓冲区所属的slab cache分配
+ *
+ *@参数：
+ *[buf]：缓冲区
+ *[offset]：在缓冲区中的偏移
+ *[len]：长度
+ *
+ *@返回值：
+ *[NULL]：没有内存，或offset + len超出缓冲区的有效数据
+ *[其他]：切片
+ **********************************************************/
+static inline buf_slice_t *buf_slice_new(buf_t *buf, uint32_t offset, uint32_t len)
+{
+    buf_slice_t *slice;
+
+    if (offset > buf->len || len > buf->len - offset)
+    {
+        return NULL;
+    }
+
+    slice = (buf_slice_t *)slab_cache_alloc(buf->cache, sizeof(buf_slice_t));
+    if (slice != NULL)
+    {
+        slist_node_init(&slice->node);
+        slice->buf = buf_get(buf);
+        slice->offset = offset;
+        slice->len = len;
+    }
+
+    return slice;
+}
+
+
+/*********************************************************
+ *@brief:
+ ***create a slice of a part of the slice
+ *
+ *@parameter:
+ *[slice]: slice
+ *[offset]: offset in the slice
+ *[len]: length
+ *
+ *@return value:
+ *[NULL]: no memory, or offset + len exceeds the slice
+ *[other]: slice
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***创建切片中一部分的切片
+ *
+ *@参数：
+ *[slice]：切片
+ *[offset]：在切片中的偏移
+ *[len]：长度
+ *
+ *@返回值：
+ *[NULL]：没有内存，或offset + len超出切片
+ *[其他]：切片
+ **********************************************************/
+static inline buf_slice_t *buf_slice_sub(buf_slice_t *slice, uint32_t offset, uint32_t len)
+{
+    if (offset > slice->len || len > slice->len - offset)
+    {
+        return NULL;
+    }
+
+    return buf_slice_new(slice->buf, slice->offset + offset, len);
+}
+
+
+/*********************************************************
+ *@brief:
+ ***free the slice and put its reference of the buffer
+ *
+ *@parameter:
+ *[slice]: slice not in a chain
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***释放切片，并释放其持有的缓冲区引用
+ *
+ *@参数：
+ *[slice]：不在链中的切片
+ **********************************************************/
+static inline void buf_slice_free(buf_slice_t *slice)
+{
+    buf_t *buf = slice->buf;
+
+    slab_cache_free(buf->cache, slice);
+    buf_put(buf);
+}
+
+
+/*********************************************************
+ *@brief:
+ ***initialize a chain
+ *
+ *@parameter:
+ *[chain]: chain
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***初始化链
+ *
+ *@参数：
+ *[chain]：链
+ **********************************************************/
+static inline void buf_chain_init(buf_chain_t *chain)
+{
+    fifo_init(&chain->slices);
+    chain->len = 0;
+}
+
+
+/*********************************************************
+ *@brief:
+ ***append a slice to the chain, the chain owns the slice
+ *
+ *@parameter:
+ *[chain]: chain
+ *[slice]: slice not in a chain
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***将切片追加到链尾，链拥有该切片
+ *
+ *@参数：
+ *[chain]：链
+ *[slice]：不在链中的切片
+ **********************************************************/
+static inline void buf_chain_append(buf_chain_t *chain, buf_slice_t *slice)
+{
+    fifo_push(&chain->slices, &slice->node);
+    chain->len += slice->len;
+}
+
+
+/*********************************************************
+ *@brief:
+ ***append a slice of the buffer to the chain
+ *
+ *@parameter:
+ *[chain]: chain
+ *[buf]: buffer
+ *[offset]: offset in the buffer
+ *[len]: length
+ *
+ *@return value:
+ *[true]: appended
+ *[false]: no memory, or offset + len exceeds the valid data of the buffer
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***将缓冲区的切片追加到链尾
+ *
+ *@参数：
+ *[chain]：链
+ *[buf]：缓冲区
+ *[offset]：在缓冲区中的偏移
+ *[len]：长度
+ *
+ *@返回值：
+ *[true]：追加成功
+ *[false]：没有内存，或offset + len超出缓冲区的有效数据
+ **********************************************************/
+static inline bool buf_chain_append_buf(buf_chain_t *chain, buf_t *buf, uint32_t offset, uint32_t len)
+{
+    buf_slice_t *slice = buf_slice_new(buf, offset, len);
+
+    if (slice == NULL)
+    {
+        return false;
+    }
+
+    buf_chain_append(chain, slice);
+
+    return true;
+}
+
+
+/*********************************************************
+ *@brief:
+ ***fill an iovec-like array with the slices from the head of the chain
+ *
+ *@parameter:
+ *[chain]: chain
+ *[iov]: array
+ *[iov_nums]: size of the array
+ *
+ *@return value:
+ ***number of the filled elements
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***从链头开始用切片填充类似iovec的数组
+ *
+ *@参数：
+ *[chain]：链
+ *[iov]：数组
+ *[iov_nums]：数组大小
+ *
+ *@返回值：
+ ***已填充的元素个数
+ **********************************************************/
+static inline uint32_t buf_chain_iov_get(buf_chain_t *chain, buf_iov_t *iov, uint32_t iov_nums)
+{
+    slist_node_t *node;
+    buf_slice_t *slice;
+    uint32_t i = 0;
+
+    slist_foreach(FIFO_LIST(&chain->slices), node)
+    {
+        if (i >= iov_nums)
+        {
+            break;
+        }
+
+        slice = BUF_SLICE_OF_NODE(node);
+        iov[i].base = BUF_SLICE_DATA(slice);
+        iov[i].len = slice->len;
+        i++;
+    }
+
+    return i;
+}
+
+
+/*********************************************************
+ *@brief:
+ ***consume len bytes from the head of the chain (e.g. after a partial send),
+ ***the fully consumed slices are freed
+ *
+ *@parameter:
+ *[chain]: chain
+ *[len]: number of bytes, no more than the length of the chain
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***从链头消耗len字节（例如部分发送之后），被完全消耗的切片将被释放
+ *
+ *@参数：
+ *[chain]：链
+ *[len]：字节数，不超过链的长度
+ **********************************************************/
+static inline void buf_chain_consume(buf_chain_t *chain, size_t len)
+{
+    buf_slice_t *slice;
+
+    chain->len -= len;
+
+    while (len && !fifo_is_empty(&chain->slices))
+    {
+        slice = BUF_SLICE_OF_NODE(FIFO_TOP(&chain->slices));
+        if (slice->len > len)
+        {
+            slice->offset += (uint32_t)len;
+            slice->len -= (uint32_t)len;
+            break;
+        }
+
+        len -= slice->len;
+        buf_slice_free(BUF_SLICE_OF_NODE(fifo_pop(&chain->slices)));
+    }
+
+    /* drop the empty slices */
+    /* 丢弃空切片 */
+    while (!fifo_is_empty(&chain->slices) && BUF_SLICE_OF_NODE(FIFO_TOP(&chain->slices))->len == 0)
+    {
+        buf_slice_free(BUF_SLICE_OF_NODE(fifo_pop(&chain->slices)));
+    }
+}
+
+
+/*********************************************************
+ *@brief:
+ ***free all the slices of the chain
+ *
+ *@parameter:
+ *[chain]: chain
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***释放链中的全部切片
+ *
+ *@参数：
+ *[chain]：链
+ **********************************************************/
+static inline void buf_chain_clear(buf_chain_t *chain)
+{
+    while (!fifo_is_empty(&chain->slices))
+    {
+        buf_slice_free(BUF_SLICE_OF_NODE(fifo_pop(&chain->slices)));
+    }
+
+    chain->len = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LIB_BUF_H__ */
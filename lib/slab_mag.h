@@ -0,0 +1,633 @@
+﻿/*
+ * Copyright (C) 2018-2019 xiaoliang<1296283984@qq.com>.
+ */
+
+#ifndef __LIB_SLAB_MAG_H__
+#define __LIB_SLAB_MAG_H__
+
+#include "atask.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************************************************
+ *@description:
+ ***Magazine caches in front of a shared slab.
+ ***Each thread (or event loop) owns a slab_mag_cache_t, allocation and
+ ***free hit a local array of blocks (a magazine) without locking.
+ ***Only when both local magazines are empty (or full) a whole magazine
+ ***is exchanged with the shared depot under a short lock.
+ ***
+ ***The slab behind a depot is only accessed under the depot lock,
+ ***it should be a fixed buffer slab (slab_init or slab_init_lazy)
+ ***and must not be waited with slab_wait, because the waiters
+ ***belong to the event loop of another thread.
+ *********************************************************
+ *@说明：
+ ***共享slab前的弹匣缓存。
+ ***每个线程（或事件循环）拥有一个slab_mag_cache_t，分配与释放都在本地的
+ ***块数组（弹匣）上完成，无需加锁。只有当两个本地弹匣都为空（或都为满）时，
+ ***才在短暂的加锁下与共享的仓库（depot）交换整个弹匣。
+ ***
+ ***仓库背后的slab只在仓库锁内访问，应为固定buffer的slab
+ ***（slab_init或slab_init_lazy），且不能使用slab_wait等待，
+ ***因为等待者属于其他线程的事件循环
+ *********************************************************/
+
+
+/*********************************************************
+ *@description:
+ ***Number of blocks per magazine
+ *********************************************************
+ *@说明：
+ ***每个弹匣的块数
+ *********************************************************/
+#ifndef CONFIG_SLAB_MAG_SIZE
+#define CONFIG_SLAB_MAG_SIZE    32
+#endif
+
+
+/*********************************************************
+ *@description:
+ ***Depot lock, a spin lock based on the GCC __atomic builtins by default.
+ ***Define SLAB_DEPOT_LOCK_TYPE, SLAB_DEPOT_LOCK_INIT, SLAB_DEPOT_LOCK
+ ***and SLAB_DEPOT_UNLOCK before including this file to use another lock
+ *********************************************************
+ *@说明：
+ ***仓库锁，默认为基于GCC __atomic内建函数的自旋锁。
+ ***在包含本文件前定义SLAB_DEPOT_LOCK_TYPE、SLAB_DEPOT_LOCK_INIT、
+ ***SLAB_DEPOT_LOCK与SLAB_DEPOT_UNLOCK以使用其他的锁
+ *********************************************************/
+#ifndef SLAB_DEPOT_LOCK_TYPE
+
+#define SLAB_DEPOT_LOCK_TYPE    uint32_t
+
+#define SLAB_DEPOT_LOCK_INIT(lock)  (*(lock) = 0)
+
+#define SLAB_DEPOT_LOCK(lock)                                           \
+    do                                                                  \
+    {                                                                   \
+        while (__atomic_exchange_n((lock), 1, __ATOMIC_ACQUIRE))        \
+        {                                                               \
+            while (__atomic_load_n((lock), __ATOMIC_RELAXED));          \
+        }                                                               \
+    } while (0)
+
+#define SLAB_DEPOT_UNLOCK(lock)     __atomic_store_n((lock), 0, __ATOMIC_RELEASE)
+
+#endif /* SLAB_DEPOT_LOCK_TYPE */
+
+
+/*********************************************************
+ *@type description:
+ *
+ *[slab_mag_t]: magazine, an array of free blocks
+ *********************************************************
+ *@类型说明：
+ *
+ *[slab_mag_t]：弹匣，空闲块的数组
+ *********************************************************/
+typedef struct slab_mag_s
+{
+    /* next magazine in the depot */
+    /* 仓库中的下一个弹匣 */
+    struct slab_mag_s *next;
+
+    /* number of blocks in the magazine */
+    /* 弹匣中的块数 */
+    uint32_t rounds;
+
+    /* blocks */
+    /* 块 */
+    void *objs[CONFIG_SLAB_MAG_SIZE];
+} slab_mag_t;
+
+
+/*********************************************************
+ *@type description:
+ *
+ *[slab_depot_t]: depot shared by the magazine caches,
+ ***keeps the full and empty magazines and the shared slab
+ *********************************************************
+ *@类型说明：
+ *
+ *[slab_depot_t]：弹匣缓存共享的仓库，保存满弹匣、空弹匣与共享的slab
+ *********************************************************/
+typedef struct slab_depot_s
+{
+    /* depot lock */
+    /* 仓库锁 */
+    SLAB_DEPOT_LOCK_TYPE lock;
+
+    /* shared slab */
+    /* 共享的slab */
+    slab_t *slab;
+
+    /* stack of full magazines */
+    /* 满弹匣栈 */
+    slab_mag_t *full;
+
+    /* stack of empty magazines */
+    /* 空弹匣栈 */
+    slab_mag_t *empty;
+
+    /* next depot in the ring of depots, for returning foreign blocks */
+    /* 仓库环中的下一个仓库，用于归还其他仓库的块 */
+    struct slab_depot_s *next;
+} slab_depot_t;
+
+
+/*********************************************************
+ *@type description:
+ *
+ *[slab_mag_cache_t]: magazine cache of a thread or event loop
+ *********************************************************
+ *@类型说明：
+ *
+ *[slab_mag_cache_t]：线程或事件循环的弹匣缓存
+ *********************************************************/
+typedef struct slab_mag_cache_s
+{
+    /* home depot */
+    /* 所属仓库 */
+    slab_depot_t *depot;
+
+    /* loaded magazine */
+    /* 装填中的弹匣 */
+    slab_mag_t *loaded;
+
+    /* previous magazine */
+    /* 前一个弹匣 */
+    slab_mag_t *prev;
+
+    /* depot of the pending foreign blocks, NULL if none */
+    /* 待归还的其他仓库块所属的仓库，没有时为NULL */
+    slab_depot_t *remote_depot;
+
+    /* number of the pending foreign blocks */
+    /* 待归还的其他仓库块的个数 */
+    uint32_t remote_nums;
+
+    /* foreign blocks returned to their depot in one lock */
+    /* 在一次加锁中归还到所属仓库的其他仓库块 */
+    void *remote[CONFIG_SLAB_MAG_SIZE];
+} slab_mag_cache_t;
+
+
+/*********************************************************
+*@description:
+***private function
+*********************************************************
+*@说明：
+***私有函数
+*********************************************************/
+
+static inline slab_mag_t *_slab_depot_private_pop(slab_mag_t **stack)
+{
+    slab_mag_t *mag = *stack;
+
+    if (mag)
+    {
+        *stack = mag->next;
+    }
+
+    return mag;
+}
+
+static inline void _slab_depot_private_push(slab_mag_t **stack, slab_mag_t *mag)
+{
+    mag->next = *stack;
+    *stack = mag;
+}
+
+/* Fill the magazine from the slab, the depot is locked */
+/* 从slab装填弹匣，仓库已加锁 */
+static inline void _slab_depot_private_fill(slab_depot_t *depot, slab_mag_t *mag)
+{
+    mag->rounds += slab_alloc_bulk(depot->slab, &mag->objs[mag->rounds], CONFIG_SLAB_MAG_SIZE - mag->rounds);
+}
+
+/* Return all blocks of the magazine to the slab, the depot is locked */
+/* 将弹匣中的所有块归还slab，仓库已加锁 */
+static inline void _slab_depot_private_flush(slab_depot_t *depot, slab_mag_t *mag)
+{
+    slab_free_bulk(depot->slab, mag->objs, mag->rounds);
+    mag->rounds = 0;
+}
+
+/* Find the depot of the block in the ring, NULL if no depot contains it */
+/* 在环中查找块所属的仓库，没有仓库包含该块时为NULL */
+static inline slab_depot_t *_slab_mag_private_depot_of(slab_depot_t *ring, void *mem)
+{
+    slab_depot_t *depot = ring;
+
+    do
+    {
+        if (slab_contains(depot->slab, mem))
+        {
+            return depot;
+        }
+        depot = depot->next;
+    } while (depot != ring);
+
+    return NULL;
+}
+
+static inline void _slab_mag_private_swap(slab_mag_cache_t *cache)
+{
+    slab_mag_t *tmp = cache->loaded;
+
+    cache->loaded = cache->prev;
+    cache->prev = tmp;
+}
+
+
+/*********************************************************
+ *@brief:
+ ***depot initialization, the magazines are provided by the caller,
+ ***each magazine cache takes two of them
+ *
+ *@contract:
+ ***1. slab is a fixed buffer slab without waiters
+ ***2. mag_nums is at least 2 times the number of the caches
+ *
+ *@parameter:
+ *[depot]: depot
+ *[slab]: shared slab
+ *[mags]: magazines
+ *[mag_nums]: number of magazines
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***仓库初始化，弹匣由调用者提供，每个弹匣缓存占用其中两个
+ *
+ *@约定：
+ ***1、slab为没有等待者的固定buffer的slab
+ ***2、mag_nums至少为弹匣缓存个数的2倍
+ *
+ *@参数：
+ *[depot]：仓库
+ *[slab]：共享的slab
+ *[mags]：弹匣
+ *[mag_nums]：弹匣个数
+ **********************************************************/
+static inline void slab_depot_init(slab_depot_t *depot, slab_t *slab, slab_mag_t *mags, uint32_t mag_nums)
+{
+    uint32_t i;
+
+    SLAB_DEPOT_LOCK_INIT(&depot->lock);
+    depot->slab = slab;
+    depot->full = NULL;
+    depot->empty = NULL;
+    depot->next = depot;
+
+    for (i = 0; i < mag_nums; i++)
+    {
+        mags[i].rounds = 0;
+        _slab_depot_private_push(&depot->empty, &mags[i]);
+    }
+}
+
+
+/*********************************************************
+ *@brief:
+ ***add the depot into the ring of the other depot,
+ ***so that the blocks of the depots can be freed through any cache
+ *
+ *@contract:
+ ***1. called before the depots are used by multiple threads
+ *
+ *@parameter:
+ *[depot]: depot not in any ring
+ *[ring]: depot in the ring
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***将仓库加入另一个仓库所在的环中，使各仓库的块可通过任意缓存释放
+ *
+ *@约定：
+ ***1、在多个线程使用仓库之前调用
+ *
+ *@参数：
+ *[depot]：不在任何环中的仓库
+ *[ring]：环中的仓库
+ **********************************************************/
+static inline void slab_depot_link(slab_depot_t *depot, slab_depot_t *ring)
+{
+    depot->next = ring->next;
+    ring->next = depot;
+}
+
+
+/*********************************************************
+ *@brief:
+ ***free a block directly to the slab of the depot under the lock
+ *
+ *@parameter:
+ *[depot]: home depot of the block
+ *[mem]: memory block
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***在锁内将块直接释放到仓库的slab
+ *
+ *@参数：
+ *[depot]：块所属的仓库
+ *[mem]：内存块
+ **********************************************************/
+static inline void slab_depot_free(slab_depot_t *depot, void *mem)
+{
+    SLAB_DEPOT_LOCK(&depot->lock);
+    slab_free(depot->slab, mem);
+    SLAB_DEPOT_UNLOCK(&depot->lock);
+}
+
+
+/*********************************************************
+ *@brief:
+ ***return the pending foreign blocks of the cache to their depot
+ ***under one lock. slab_mag_free keeps the foreign blocks of one depot
+ ***until the magazine size is reached or a block of another depot is freed,
+ ***call it when the thread goes idle so that the blocks do not linger
+ *
+ *@parameter:
+ *[cache]: magazine cache
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***在一次加锁中将缓存中待归还的其他仓库块归还到其所属仓库。
+ ***slab_mag_free暂存同一仓库的其他仓库块，直到达到弹匣大小或释放了
+ ***另一仓库的块，线程空闲时调用以免这些块滞留
+ *
+ *@参数：
+ *[cache]：弹匣缓存
+ **********************************************************/
+static inline void slab_mag_remote_flush(slab_mag_cache_t *cache)
+{
+    slab_depot_t *depot = cache->remote_depot;
+
+    if (depot == NULL)
+    {
+        return;
+    }
+
+    SLAB_DEPOT_LOCK(&depot->lock);
+    slab_free_bulk(depot->slab, cache->remote, cache->remote_nums);
+    SLAB_DEPOT_UNLOCK(&depot->lock);
+
+    cache->remote_depot = NULL;
+    cache->remote_nums = 0;
+}
+
+
+/*********************************************************
+ *@brief:
+ ***magazine cache initialization, takes two empty magazines from the depot
+ *
+ *@parameter:
+ *[cache]: magazine cache
+ *[depot]: home depot
+ *
+ *@return value:
+ *[true]: initialized
+ *[false]: no enough empty magazines in the depot
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***弹匣缓存初始化，从仓库取出两个空弹匣
+ *
+ *@参数：
+ *[cache]：弹匣缓存
+ *[depot]：所属仓库
+ *
+ *@返回值：
+ *[true]：初始化成功
+ *[false]：仓库中没有足够的空弹匣
+ **********************************************************/
+static inline bool slab_mag_cache_init(slab_mag_cache_t *cache, slab_depot_t *depot)
+{
+    cache->depot = depot;
+    cache->remote_depot = NULL;
+    cache->remote_nums = 0;
+
+    SLAB_DEPOT_LOCK(&depot->lock);
+    cache->loaded = _slab_depot_private_pop(&depot->empty);
+    cache->prev = _slab_depot_private_pop(&depot->empty);
+    if (cache->prev == NULL && cache->loaded)
+    {
+        _slab_depot_private_push(&depot->empty, cache->loaded);
+        cache->loaded = NULL;
+    }
+    SLAB_DEPOT_UNLOCK(&depot->lock);
+
+    return cache->loaded != NULL;
+}
+
+
+/*********************************************************
+ *@brief:
+ ***return the magazines and blocks of the cache to the depot,
+ ***the cache can no longer be used
+ *
+ *@parameter:
+ *[cache]: magazine cache
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***将缓存的弹匣与块归还仓库，之后缓存不能再被使用
+ *
+ *@参数：
+ *[cache]：弹匣缓存
+ **********************************************************/
+static inline void slab_mag_cache_drain(slab_mag_cache_t *cache)
+{
+    slab_depot_t *depot = cache->depot;
+    slab_mag_t *mags[2];
+    int i;
+
+    slab_mag_remote_flush(cache);
+
+    mags[0] = cache->loaded;
+    mags[1] = cache->prev;
+
+    SLAB_DEPOT_LOCK(&depot->lock);
+    for (i = 0; i < 2; i++)
+    {
+        if (mags[i]->rounds == CONFIG_SLAB_MAG_SIZE)
+        {
+            _slab_depot_private_push(&depot->full, mags[i]);
+        }
+        else
+        {
+            _slab_depot_private_flush(depot, mags[i]);
+            _slab_depot_private_push(&depot->empty, mags[i]);
+        }
+    }
+    SLAB_DEPOT_UNLOCK(&depot->lock);
+
+    cache->loaded = NULL;
+    cache->prev = NULL;
+}
+
+
+/*********************************************************
+ *@brief:
+ ***allocate a block from the magazine cache,
+ ***the depot is locked only when both local magazines are empty
+ *
+ *@parameter:
+ *[cache]: magazine cache
+ *
+ *@return: memory block, NULL if the shared slab is exhausted
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***从弹匣缓存分配一个块，只有两个本地弹匣都为空时才对仓库加锁
+ *
+ *@参数：
+ *[cache]：弹匣缓存
+ *
+ *@返回：内存块，共享slab耗尽时为NULL
+ **********************************************************/
+static inline void *slab_mag_alloc(slab_mag_cache_t *cache)
+{
+    slab_depot_t *depot;
+    slab_mag_t *full;
+
+    if (cache->loaded->rounds)
+    {
+        return cache->loaded->objs[--cache->loaded->rounds];
+    }
+
+    if (cache->prev->rounds)
+    {
+        _slab_mag_private_swap(cache);
+
+        return cache->loaded->objs[--cache->loaded->rounds];
+    }
+
+    /* both magazines are empty, exchange with the depot */
+    /* 两个弹匣都为空，与仓库交换 */
+    depot = cache->depot;
+
+    SLAB_DEPOT_LOCK(&depot->lock);
+    full = _slab_depot_private_pop(&depot->full);
+    if (full)
+    {
+        _slab_depot_private_push(&depot->empty, cache->prev);
+        cache->prev = cache->loaded;
+        cache->loaded = full;
+    }
+    else
+    {
+        _slab_depot_private_fill(depot, cache->loaded);
+    }
+    SLAB_DEPOT_UNLOCK(&depot->lock);
+
+    if (cache->loaded->rounds)
+    {
+        return cache->loaded->objs[--cache->loaded->rounds];
+    }
+
+    return NULL;
+}
+
+
+/*********************************************************
+ *@brief:
+ ***free a block to the magazine cache,
+ ***the depot is locked only when both local magazines are full.
+ ***the blocks of another depot in the ring are collected
+ ***and returned to their home depot in batches, see slab_mag_remote_flush
+ *
+ *@parameter:
+ *[cache]: magazine cache
+ *[mem]: memory block allocated from a depot in the ring
+ *
+ *@return value:
+ *[true]: freed
+ *[false]: the block does not belong to any depot in the ring, it is not freed
+ *********************************************************/
+/*********************************************************
+ *@简要：
+ ***释放一个块到弹匣缓存，只有两个本地弹匣都为满时才对仓库加锁。
+ ***环中其他仓库的块被收集后分批归还到其所属的仓库，见slab_mag_remote_flush
+ *
+ *@参数：
+ *[cache]：弹匣缓存
+ *[mem]：从环中的仓库分配的内存块
+ *
+ *@返回值：
+ *[true]：释放成功
+ *[false]：块不属于环中的任何仓库，未被释放
+ **********************************************************/
+static inline bool slab_mag_free(slab_mag_cache_t *cache, void *mem)
+{
+    slab_depot_t *depot = cache->depot;
+    slab_mag_t *empty;
+
+    /* the block belongs to another depot */
+    /* 块属于其他仓库 */
+    if (!slab_contains(depot->slab, mem))
+    {
+        if (cache->remote_depot == NULL || !slab_contains(cache->remote_depot->slab, mem))
+        {
+            depot = _slab_mag_private_depot_of(depot->next, mem);
+            if (depot == NULL)
+            {
+                return false;
+            }
+
+            slab_mag_remote_flush(cache);
+            cache->remote_depot = depot;
+        }
+
+        cache->remote[cache->remote_nums++] = mem;
+        if (cache->remote_nums == CONFIG_SLAB_MAG_SIZE)
+        {
+            slab_mag_remote_flush(cache);
+        }
+
+        return true;
+    }
+
+    if (cache->loaded->rounds < CONFIG_SLAB_MAG_SIZE)
+    {
+        cache->loaded->objs[cache->loaded->rounds++] = mem;
+        return true;
+    }
+
+    if (cache->prev->rounds < CONFIG_SLAB_MAG_SIZE)
+    {
+        _slab_mag_private_swap(cache);
+        cache->loaded->objs[cache->loaded->rounds++] = mem;
+        return true;
+    }
+
+    /* both magazines are full, exchange with the depot */
+    /* 两个弹匣都为满，与仓库交换 */
+    SLAB_DEPOT_LOCK(&depot->lock);
+    empty = _slab_depot_private_pop(&depot->empty);
+    if (empty)
+    {
+        _slab_depot_private_push(&depot->full, cache->prev);
+        cache->prev = cache->loaded;
+        cache->loaded = empty;
+    }
+    else
+    {
+        _slab_depot_private_flush(depot, cache->loaded);
+    }
+    SLAB_DEPOT_UNLOCK(&depot->lock);
+
+    cache->loaded->objs[cache->loaded->rounds++] = mem;
+
+    return true;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LIB_SLAB_MAG_H__ */